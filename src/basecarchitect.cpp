@@ -16,18 +16,26 @@ BaseCArchitect::BaseCArchitect(const InputInstance& inputInstance,
     , _k(k)
     , _forceDiploid(forceDiploid)
     , _rootNotFixed(rootNotFixed)
+    , _symmetryBreaking(false)
+    , _parent()
+    , _lazyConstraints(false)
     , _F(inputInstance.F())
     , _numChr(inputInstance.numChr())
     , _m(inputInstance.m())
     , _n(inputInstance.n())
     , _num_vertices(2*_k - 1)
-    , _env()
+    , _env(EnvFactory::create())
     , _model(_env)
     , _cplex(_model)
     , _T(_k, _numChr, _n)
+    , _lb_y()
+    , _ub_y()
     , _x()
     , _y()
     , _bar_f()
+    , _fitLower()
+    , _fitUpper()
+    , _lazyRows(_env)
     , _obj(_env)
     , _completeHotStart(_env)
     , _partialHotStart(_env)
@@ -38,9 +46,17 @@ BaseCArchitect::BaseCArchitect(const InputInstance& inputInstance,
 
 void BaseCArchitect::init()
 {
+    tightenBounds();
     buildVariables();
     buildConstraints();
     buildObjective();
+
+    // CPLEX checks the lazy rows at every candidate integer solution and
+    // only adds those that are violated to the LP
+    if (_lazyConstraints && _lazyRows.getSize() > 0)
+    {
+        _cplex.addLazyConstraints(_lazyRows);
+    }
 }
 
 bool BaseCArchitect::solve(const int timeLimit, const int memoryLimit, const int nrThreads)
@@ -102,16 +118,35 @@ bool BaseCArchitect::solve(const int timeLimit, const int memoryLimit, const int
     return res;
 }
 
-Int3Array BaseCArchitect::getC()
+void BaseCArchitect::updateM(const DoubleMatrix& M)
+{
+    _M = M;
+
+    for(unsigned int chr = 0; chr < _numChr; ++chr)
+    {
+        for(unsigned int p = 0; p < _m; ++p)
+        {
+            for(unsigned int s = 0; s < _n[chr]; ++s)
+            {
+                for(unsigned int i = (_k - 1); i < _num_vertices; ++i)
+                {
+                    int remapped_i = i - (_k - 1);
+                    _fitLower[chr][p][s].setLinearCoef(_y[chr][i][s], _M[p][remapped_i]);
+                    _fitUpper[chr][p][s].setLinearCoef(_y[chr][i][s], -_M[p][remapped_i]);
+                }
+            }
+        }
+    }
+}
+
+IntRaggedArray BaseCArchitect::getC()
 {
-    Int3Array result(_numChr);
+    IntRaggedArray result(_n, _k);
     for(unsigned chr = 0; chr < _numChr; ++chr)
     {
-        result[chr] = IntMatrix(_k);
         for(unsigned int i = _k-1; i < _num_vertices; ++i)
         {
             unsigned int remapped_i = i - (_k-1);
-            result[chr][remapped_i] = IntArray(_n[chr]);
             for(unsigned int s = 0; s < _n[chr]; ++s)
             {
                 result[chr][remapped_i][s] = _cplex.getIntValue(_y[chr][i][s]);
@@ -121,6 +156,23 @@ Int3Array BaseCArchitect::getC()
     return result;
 }
 
+IntRaggedArray BaseCArchitect::getC(const int soln)
+{
+    IntRaggedArray result(_n, _k);
+    for(unsigned chr = 0; chr < _numChr; ++chr)
+    {
+        for(unsigned int i = _k-1; i < _num_vertices; ++i)
+        {
+            unsigned int remapped_i = i - (_k-1);
+            for(unsigned int s = 0; s < _n[chr]; ++s)
+            {
+                result[chr][remapped_i][s] = std::floor(_cplex.getValue(_y[chr][i][s], soln) + 0.5);
+            }
+        }
+    }
+    return result;
+}
+
 void BaseCArchitect::exportModel(const std::string& filename) const
 {
     _cplex.exportModel(filename.c_str());
@@ -128,6 +180,9 @@ void BaseCArchitect::exportModel(const std::string& filename) const
 
 void BaseCArchitect::constructTree()
 {
+    // the model may be solved more than once
+    _T = CopyNumberTree(_k, _numChr, _n);
+
     // add and label arcs
     for(unsigned int i = 0; i < (_k - 1); ++i)
     {
@@ -157,6 +212,29 @@ void BaseCArchitect::constructTree()
     }
 }
 
+void BaseCArchitect::tightenBounds()
+{
+    /**
+     The fit is a soft constraint, so F and M do not bound y. Only the root
+     and the forced normal diploid clone are fixed to 2, every other vertex
+     is bounded by e.
+     **/
+    _lb_y = IntRaggedArray(_n, _num_vertices, 0);
+    _ub_y = IntRaggedArray(_n, _num_vertices, 0);
+    for(unsigned int chr = 0; chr < _numChr; ++chr)
+    {
+        for(unsigned int i = 0; i < _num_vertices; ++i)
+        {
+            const bool diploid = (i == 0 && !_rootNotFixed) || (i == _k - 1 && _forceDiploid);
+            for(unsigned int s = 0; s < _n[chr]; ++s)
+            {
+                _lb_y[chr][i][s] = diploid ? 2 : 0;
+                _ub_y[chr][i][s] = diploid ? 2 : _e[chr][s];
+            }
+        }
+    }
+}
+
 void BaseCArchitect::buildVariables()
 {
     char buf[1024];
@@ -184,7 +262,7 @@ void BaseCArchitect::buildVariables()
             for(unsigned int s = 0; s < _n[chr]; ++s)
             {
                 snprintf(buf, 1024, "y_%d_%d_%d", chr, i, s);
-                _y[chr][i][s] = IloIntVar(_env, 0, _e[chr][s], buf);
+                _y[chr][i][s] = IloIntVar(_env, _lb_y[chr][i][s], _ub_y[chr][i][s], buf);
                 _completeHotStart.add(_y[chr][i][s]);
                 _partialHotStart.add(_y[chr][i][s]);
             }
@@ -209,10 +287,20 @@ void BaseCArchitect::buildVariables()
 
 void BaseCArchitect::buildConstraints()
 {
+    /**
+     bar_f - F + sum_u_y >= 0 and bar_f + F - sum_u_y >= 0, kept as ranges
+     such that their M coefficients can be updated by updateM
+     **/
+    _fitLower = IloRange3Array(_env, _numChr);
+    _fitUpper = IloRange3Array(_env, _numChr);
     for(unsigned int chr = 0; chr < _numChr; ++chr)
     {
+        _fitLower[chr] = IloRangeMatrix(_env, _m);
+        _fitUpper[chr] = IloRangeMatrix(_env, _m);
         for(unsigned int p = 0; p < _m; ++p)
         {
+            _fitLower[chr][p] = IloRangeArray(_env, _n[chr]);
+            _fitUpper[chr][p] = IloRangeArray(_env, _n[chr]);
             for(unsigned int s = 0; s < _n[chr]; ++s)
             {
                 IloExpr sum_u_y(_env);
@@ -223,8 +311,11 @@ void BaseCArchitect::buildConstraints()
                     sum_u_y += _M[p][remapped_i] * _y[chr][i][s];
                 }
 
-                _model.add(_bar_f[chr][p][s] - _F[chr][p][s] + sum_u_y >= 0);
-                _model.add(_bar_f[chr][p][s] + _F[chr][p][s] - sum_u_y >= 0);
+                _fitLower[chr][p][s] = IloRange(_env, _F[chr][p][s], _bar_f[chr][p][s] + sum_u_y, IloInfinity);
+                _fitUpper[chr][p][s] = IloRange(_env, -_F[chr][p][s], _bar_f[chr][p][s] - sum_u_y, IloInfinity);
+                _model.add(_fitLower[chr][p][s]);
+                _model.add(_fitUpper[chr][p][s]);
+                sum_u_y.end();
             }
         }
     }
@@ -267,6 +358,54 @@ void BaseCArchitect::buildConstraints()
         _model.add(cons);
     }
 
+    /**
+     \sum_{i < j} i x_{i,j} <= \sum_{i < j+1} i x_{i,j+1} for 1 <= j < k - 2
+
+     The parents of the internal vertices are non-decreasing, i.e. internal
+     vertices are numbered in breadth-first order. Every tree has such a
+     numbering and renumbering internal vertices changes neither the
+     profiles of the leaves nor the cost.
+     **/
+    if (_symmetryBreaking)
+    {
+        for(unsigned int j = 1; j + 1 < _k - 1; ++j)
+        {
+            IloExpr parent_j(_env);
+            IloExpr parent_next(_env);
+
+            for(unsigned int i = 0; i < j; ++i)
+            {
+                parent_j += (double)i * _x[i][remap_j(i, j)];
+            }
+            for(unsigned int i = 0; i < j + 1; ++i)
+            {
+                parent_next += (double)i * _x[i][remap_j(i, j + 1)];
+            }
+
+            IloConstraint cons(parent_j <= parent_next);
+            snprintf(buf, 1024, "bfs_order_%d", j);
+            cons.setName(buf);
+            _model.add(cons);
+        }
+    }
+
+    /**
+     x_{i,j} = 1 if and only if i is the parent of j, for a fixed topology
+     **/
+    if (!_parent.empty())
+    {
+        for(unsigned int i = 0; i < (_k - 1); ++i)
+        {
+            for(unsigned int j = (i + 1); j < _num_vertices; ++j)
+            {
+                IloConstraint cons(_x[i][remap_j(i, j)] == (_parent[j] == (int)i ? 1 : 0));
+                snprintf(buf, 1024, "topology_%d_%d", i, j);
+                cons.setName(buf);
+                _model.add(cons);
+            }
+        }
+    }
+
     /**
      y_{1,s} = 2 for 1 <= s <= n
      **/
@@ -312,7 +451,7 @@ void BaseCArchitect::buildObjective()
         {
             for(unsigned int s = 0; s < _n[chr]; ++s)
             {
-                _obj += _bar_f[chr][p][s];
+                _obj += _inputInstance.w()[chr][s] * _bar_f[chr][p][s];
             }
         }
     }
@@ -334,6 +473,20 @@ HotStart BaseCArchitect::getCompleteHotStart()
     return result;
 }
 
+HotStart BaseCArchitect::getCompleteHotStart(const int soln)
+{
+    int size =  _completeHotStart.getSize();
+    IloNumArray values(_env, size);
+    _cplex.getValues(values, _completeHotStart, soln);
+    HotStart result(size, 0);
+    for(unsigned int i = 0; i < size; ++i)
+    {
+        result[i] = std::floor(values[i] + 0.5);
+    }
+    values.end();
+    return result;
+}
+
 HotStart BaseCArchitect::getPartialHotStart()
 {
     int size =  _partialHotStart.getSize();
@@ -384,4 +537,11 @@ int BaseCArchitect::addPartialHotStart(const HotStart& partialHotStart)
     return res;
 }
 
-
+void BaseCArchitect::clearHotStarts()
+{
+    int nrHotStarts = _cplex.getNMIPStarts();
+    if (nrHotStarts > 0)
+    {
+        _cplex.deleteMIPStarts(0, nrHotStarts);
+    }
+}
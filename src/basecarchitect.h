@@ -12,6 +12,7 @@
 #include <cmath>
 #include <numeric>
 #include <ilcplex/ilocplex.h>
+#include "envfactory.h"
 #include "copynumbertree.h"
 #include "inputinstance.h"
 
@@ -34,16 +35,41 @@ public:
     {
         _completeHotStart.end();
         _partialHotStart.end();
+        _lazyRows.end();
         _cplex.end();
         _model.end();
         _env.end();
     }
 
+    /// Number the internal vertices in breadth-first order, to be set before init()
+    void setSymmetryBreaking(const bool symmetryBreaking)
+    {
+        _symmetryBreaking = symmetryBreaking;
+    }
+
+    /// Add the rows that only bind on selected arcs to the lazy constraint
+    /// pool instead of the model, to be set before init()
+    void setLazyConstraints(const bool lazyConstraints)
+    {
+        _lazyConstraints = lazyConstraints;
+    }
+
+    /// Fix the tree to the given parent of every vertex (-1 for the root),
+    /// to be set before init(). Parents must precede their children.
+    void setTopology(const IntArray& parent)
+    {
+        assert(parent.empty() || parent.size() == _num_vertices);
+        _parent = parent;
+    }
+
     void init();
     
     bool solve(const int timeLimit, const int memoryLimit, const int nrThreads);
 
-    Int3Array getC();
+    /// Replace the usage matrix by updating the coefficients of the fit constraints in place
+    void updateM(const DoubleMatrix& M);
+
+    IntRaggedArray getC();
     
     virtual int getDelta() = 0;
 
@@ -61,10 +87,42 @@ public:
 
     int addCompleteHotStart(const HotStart& completeHotStart);
     int addPartialHotStart(const HotStart& partialHotStart);
+    /// Remove all previously added hot starts
+    void clearHotStarts();
 
     HotStart getCompleteHotStart();
     HotStart getPartialHotStart();
 
+    /// Number of solutions in the solution pool of the last solve
+    int getNumPoolSolutions()
+    {
+        return _cplex.getSolnPoolNsolns();
+    }
+
+    /// Number of rows of the extracted model, the lazy rows excluded
+    int getNumRows() const
+    {
+        return _cplex.getNrows();
+    }
+
+    /// Number of rows handed to CPLEX as lazy constraints
+    int getNumLazyRows() const
+    {
+        return _lazyRows.getSize();
+    }
+
+    /// Objective value of pool solution soln
+    double getObjValue(const int soln)
+    {
+        return _cplex.getObjValue(soln);
+    }
+
+    /// Leaf copy numbers of pool solution soln
+    IntRaggedArray getC(const int soln);
+
+    /// Complete HotStart of pool solution soln
+    HotStart getCompleteHotStart(const int soln);
+
     double getUB()
     {
         return _cplex.getObjValue();
@@ -92,6 +150,9 @@ protected:
     typedef IloArray<IloNumVar3Array> IloNumVar4Array;
     typedef IloArray<IloNumVar4Array> IloNumVar5Array;
 
+    typedef IloArray<IloRangeArray> IloRangeMatrix;
+    typedef IloArray<IloRangeMatrix> IloRange3Array;
+
     typedef IloArray<IloIntVarArray> IloIntVarMatrix;
     typedef IloArray<IloIntVarMatrix> IloIntVar3Array;
     typedef IloArray<IloIntVar3Array> IloIntVar4Array;
@@ -103,6 +164,22 @@ protected:
         return j - (i + 1);
     }
 
+    /// Add a row that only binds if its arc is selected, to the model or
+    /// to the lazy rows
+    void addArcRow(const IloConstraint& cons)
+    {
+        if (_lazyConstraints)
+        {
+            _lazyRows.add(cons);
+        }
+        else
+        {
+            _model.add(cons);
+        }
+    }
+
+    /// Derive bounds on the variables before the model is built
+    virtual void tightenBounds();
     /// Build variables
     virtual void buildVariables();
     /// Build constraints
@@ -118,19 +195,25 @@ protected:
     /// Input instance
     const InputInstance& _inputInstance;
     /// Usage matrix
-    const DoubleMatrix& _M;
+    DoubleMatrix _M;
     /// Maximum copy number per chromosome, per position
     const IntMatrix &_e;
     /// Maximum number of events per chromosome
-    const int _Z;
+    int _Z;
     /// Number of leaves
     const unsigned int _k;
     /// Force the presence of the normal diploid clone
     const bool _forceDiploid;
     /// Do not fix the root to the normal diploid
     const bool _rootNotFixed;
+    /// Exclude relabelings of the internal vertices
+    bool _symmetryBreaking;
+    /// Fixed parent of every vertex, empty if the topology is free
+    IntArray _parent;
+    /// Keep the rows that only bind on selected arcs in the lazy constraint pool
+    bool _lazyConstraints;
     /// Input frequencies from _inputInstance
-    const Double3Array& _F;
+    const DoubleRaggedArray& _F;
     /// Number of chromosomes
     const unsigned int _numChr;
     /// Number of samples
@@ -147,12 +230,22 @@ protected:
     IloCplex _cplex;
     /// Resulting copy number tree
     CopyNumberTree _T;
+    /// Lower bound on y per chromosome, vertex, position
+    IntRaggedArray _lb_y;
+    /// Upper bound on y per chromosome, vertex, position
+    IntRaggedArray _ub_y;
     /// TODO
     IloBoolVarMatrix _x;
     /// TODO
     IloIntVar3Array _y;
     /// TODO
     IloNumVar3Array _bar_f;
+    /// Fit constraints bar_f - F + sum_u_y >= 0 per chromosome, sample, position
+    IloRange3Array _fitLower;
+    /// Fit constraints bar_f + F - sum_u_y >= 0 per chromosome, sample, position
+    IloRange3Array _fitUpper;
+    /// Rows that only bind on selected arcs, if lazy constraints are enabled
+    IloConstraintArray _lazyRows;
     /// TODO
     IloExpr _obj;
     /// TODO
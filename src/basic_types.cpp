@@ -6,8 +6,6 @@ std::mt19937 g_rng;
 
 VerbosityLevel g_verbosity;
 
-boost::mutex g_mutex;
-
 boost::mutex g_output_mutex;
 
 int countElements(const IntMatrix arg)
@@ -16,14 +16,13 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/date_time/posix_time/posix_time_io.hpp>
 #include <limits>
+#include <cassert>
 
 extern lemon::Tolerance<double> g_tol;
 
 /// Random number generator
 extern std::mt19937 g_rng;
 
-extern boost::mutex g_mutex;
-
 extern boost::mutex g_output_mutex;
 
 typedef enum
@@ -47,6 +46,217 @@ typedef std::vector<DoubleMatrix> Double3Array;
 typedef std::vector<Double3Array> Double4Array;
 
 
+/// Contiguous [chr][row][s] array where every chromosome has the same number
+/// of rows and its own number of positions n[chr]. All elements share one
+/// buffer, chromosome by chromosome and row by row, such that copies are a
+/// single allocation and the positions of a row are adjacent in memory.
+/// Indexing returns lightweight views, so C[chr][i][s] reads as with nested
+/// vectors. It converts from and to nested vectors.
+template<typename T>
+class RaggedArray
+{
+public:
+    /// View of the n[chr] positions of a row
+    template<typename U>
+    class RowView
+    {
+    public:
+        RowView(U* data, const int size)
+            : _data(data)
+            , _size(size)
+        {
+        }
+
+        U& operator[](const int s) const
+        {
+            assert(0 <= s && s < _size);
+            return _data[s];
+        }
+
+        int size() const
+        {
+            return _size;
+        }
+
+        U* begin() const
+        {
+            return _data;
+        }
+
+        U* end() const
+        {
+            return _data + _size;
+        }
+
+    private:
+        U* _data;
+        int _size;
+    };
+
+    /// View of the rows of a chromosome
+    template<typename U>
+    class ChromosomeView
+    {
+    public:
+        ChromosomeView(U* data, const int rows, const int n)
+            : _data(data)
+            , _rows(rows)
+            , _n(n)
+        {
+        }
+
+        RowView<U> operator[](const int i) const
+        {
+            assert(0 <= i && i < _rows);
+            return RowView<U>(_data + i * _n, _n);
+        }
+
+        int size() const
+        {
+            return _rows;
+        }
+
+    private:
+        U* _data;
+        int _rows;
+        int _n;
+    };
+
+    typedef std::vector<std::vector<std::vector<T> > > Nested;
+
+    RaggedArray()
+        : _rows(0)
+        , _n()
+        , _offset(1, 0)
+        , _data()
+    {
+    }
+
+    RaggedArray(const IntArray& n, const int rows, const T& value = T())
+        : _rows(rows)
+        , _n(n)
+        , _offset(n.size() + 1, 0)
+        , _data()
+    {
+        for (unsigned int chr = 0; chr < _n.size(); ++chr)
+        {
+            _offset[chr + 1] = _offset[chr] + _rows * _n[chr];
+        }
+        _data = std::vector<T>(_offset.back(), value);
+    }
+
+    /// Copy nested vectors, every chromosome must have the same number of rows
+    RaggedArray(const Nested& nested)
+        : _rows(nested.empty() ? 0 : nested[0].size())
+        , _n(nested.size(), 0)
+        , _offset(nested.size() + 1, 0)
+        , _data()
+    {
+        for (unsigned int chr = 0; chr < nested.size(); ++chr)
+        {
+            assert(nested[chr].size() == _rows);
+            _n[chr] = _rows == 0 ? 0 : nested[chr][0].size();
+            _offset[chr + 1] = _offset[chr] + _rows * _n[chr];
+        }
+        _data.reserve(_offset.back());
+        for (unsigned int chr = 0; chr < nested.size(); ++chr)
+        {
+            for (int i = 0; i < _rows; ++i)
+            {
+                assert(nested[chr][i].size() == _n[chr]);
+                _data.insert(_data.end(), nested[chr][i].begin(), nested[chr][i].end());
+            }
+        }
+    }
+
+    operator Nested() const
+    {
+        Nested result(_n.size());
+        for (unsigned int chr = 0; chr < _n.size(); ++chr)
+        {
+            result[chr] = std::vector<std::vector<T> >(_rows);
+            for (int i = 0; i < _rows; ++i)
+            {
+                const RowView<const T> row = (*this)[chr][i];
+                result[chr][i] = std::vector<T>(row.begin(), row.end());
+            }
+        }
+        return result;
+    }
+
+    ChromosomeView<T> operator[](const int chr)
+    {
+        assert(0 <= chr && chr < (int)_n.size());
+        return ChromosomeView<T>(_data.data() + _offset[chr], _rows, _n[chr]);
+    }
+
+    ChromosomeView<const T> operator[](const int chr) const
+    {
+        assert(0 <= chr && chr < (int)_n.size());
+        return ChromosomeView<const T>(_data.data() + _offset[chr], _rows, _n[chr]);
+    }
+
+    /// Array that consists of chromosome chr only
+    RaggedArray chromosome(const int chr) const
+    {
+        RaggedArray result(IntArray(1, _n[chr]), _rows);
+        std::copy(_data.begin() + _offset[chr], _data.begin() + _offset[chr + 1], result._data.begin());
+        return result;
+    }
+
+    /// Number of chromosomes
+    int size() const
+    {
+        return _n.size();
+    }
+
+    bool empty() const
+    {
+        return _n.empty();
+    }
+
+    /// Number of rows of every chromosome
+    int rows() const
+    {
+        return _rows;
+    }
+
+    /// Number of positions of each chromosome
+    const IntArray& n() const
+    {
+        return _n;
+    }
+
+    /// All elements, chromosome by chromosome and row by row
+    const std::vector<T>& data() const
+    {
+        return _data;
+    }
+
+    bool operator==(const RaggedArray& other) const
+    {
+        return _rows == other._rows && _n == other._n && _data == other._data;
+    }
+
+    bool operator!=(const RaggedArray& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    /// Number of rows of every chromosome
+    int _rows;
+    /// Number of positions of each chromosome
+    IntArray _n;
+    /// Index of the first element of each chromosome, and the total size
+    IntArray _offset;
+    /// Elements
+    std::vector<T> _data;
+};
+
+typedef RaggedArray<int> IntRaggedArray;
+typedef RaggedArray<double> DoubleRaggedArray;
+
 typedef std::set<int> IntSet;
 typedef std::pair<IntSet, IntSet> IntSetPair;
 
@@ -16,9 +16,18 @@ CArchitect::CArchitect(const InputInstance& inputInstance,
     , _d()
     , _bar_a()
     , _bar_d()
+    , _budget()
+    , _ub_a()
+    , _ub_d()
 {
 }
 
+void CArchitect::updateZ(const int Z)
+{
+    _Z = Z;
+    _budget.setUB(_Z);
+}
+
 int CArchitect::getDelta()
 {
     double result = 0.0;
@@ -76,13 +85,9 @@ void CArchitect::constructTree()
     }
 
     // construct events
-    const CopyNumberTree::Digraph& T = _T.T();
-    for (CopyNumberTree::ArcIt a_ij(T); a_ij != lemon::INVALID; ++a_ij)
+    for (int j = 1; j < (int)_num_vertices; ++j)
     {
-        CopyNumberTree::Node v_i = T.source(a_ij);
-        CopyNumberTree::Node v_j = T.target(a_ij);
-        const int i = _T.index(v_i);
-        const int j = _T.index(v_j);
+        const int i = _T.parent(j);
         const int remapped_j = remap_j(i, j);
       
         for (unsigned int chr = 0; chr < _numChr; ++chr)
@@ -130,6 +135,29 @@ void CArchitect::constructTree()
     }
 }
 
+void CArchitect::tightenBounds()
+{
+    BaseCArchitect::tightenBounds();
+
+    /**
+     If y_j > 0 then y_i - d >= 1, hence a <= y_j - 1. If y_j = 0 then d >= y_i
+     suffices. Otherwise a and d are free, and capping every position of an
+     arc at the same constant does not add event starts. Hence
+     a_{i,j} <= max_s ub_y_{j,s} - 1 and d_{i,j} <= max_s ub_y_{i,s}.
+     **/
+    _ub_a = IntMatrix(_numChr, IntArray(_num_vertices, 0));
+    _ub_d = IntMatrix(_numChr, IntArray(_num_vertices, 0));
+    for(unsigned int chr = 0; chr < _numChr; ++chr)
+    {
+        for(unsigned int i = 0; i < _num_vertices; ++i)
+        {
+            const int ub_y = _n[chr] > 0 ? *max_element(_ub_y[chr][i].begin(), _ub_y[chr][i].end()) : 0;
+            _ub_a[chr][i] = std::max(ub_y - 1, 0);
+            _ub_d[chr][i] = ub_y;
+        }
+    }
+}
+
 void CArchitect::buildVariables()
 {
     BaseCArchitect::buildVariables();
@@ -186,7 +214,6 @@ void CArchitect::buildVariables()
     _d = IloIntVar4Array(_env, _numChr);
     for(unsigned int chr = 0; chr < _numChr; ++chr)
     {
-        const int e = *max_element(_e[chr].begin(), _e[chr].end());
         _a[chr] = IloIntVar3Array(_env, _k - 1);
         _d[chr] = IloIntVar3Array(_env, _k - 1);
         for(unsigned int i = 0; i < _k - 1; ++i)
@@ -200,10 +227,10 @@ void CArchitect::buildVariables()
                 _d[chr][i][remapped_j] = IloIntVarArray(_env, _n[chr]);
                 for(unsigned int s = 0; s < _n[chr]; ++s)
                 {
-                    _a[chr][i][remapped_j][s] = IloIntVar(_env, 0, e);
+                    _a[chr][i][remapped_j][s] = IloIntVar(_env, 0, _ub_a[chr][j]);
                     _completeHotStart.add(_a[chr][i][remapped_j][s]);
 
-                    _d[chr][i][remapped_j][s] = IloIntVar(_env, 0, e);
+                    _d[chr][i][remapped_j][s] = IloIntVar(_env, 0, _ub_d[chr][i]);
                     _completeHotStart.add(_d[chr][i][remapped_j][s]);
                 }
             }
@@ -227,10 +254,10 @@ void CArchitect::buildVariables()
                 _bar_d[chr][i][remapped_j] = IloIntVarArray(_env, _n[chr]);
                 for(unsigned int l = 0; l < _n[chr]; ++l)
                 {
-                    _bar_a[chr][i][remapped_j][l] = IloIntVar(_env, 0, _e[chr][l]);
+                    _bar_a[chr][i][remapped_j][l] = IloIntVar(_env, 0, std::min(_e[chr][l], _ub_a[chr][j]));
                     _completeHotStart.add(_bar_a[chr][i][remapped_j][l]);
 
-                    _bar_d[chr][i][remapped_j][l] = IloIntVar(_env, 0, _e[chr][l]);
+                    _bar_d[chr][i][remapped_j][l] = IloIntVar(_env, 0, std::min(_e[chr][l], _ub_d[chr][i]));
                     _completeHotStart.add(_bar_d[chr][i][remapped_j][l]);
                 }
             }
@@ -259,7 +286,8 @@ void CArchitect::buildConstraints()
             }
         }
     }
-    _model.add(sum_bars <= _Z);
+    _budget = IloRange(_env, -IloInfinity, sum_bars, _Z);
+    _model.add(_budget);
 
     for(unsigned int chr = 0; chr < _numChr; ++chr)
     {
@@ -294,9 +322,14 @@ void CArchitect::buildConstraints()
         }
     }
 
+    /**
+     The big-M coefficients are the largest violation of each row when it is
+     not active, given the bounds of tightenBounds. These rows and the rows
+     counting the event starts only bind on selected arcs, so they may be
+     kept out of the LP as lazy rows.
+     **/
     for(unsigned int chr = 0; chr < _numChr; ++chr)
     {
-        const int e = *max_element(_e[chr].begin(), _e[chr].end());
         for(unsigned int i = 0; i < _k - 1; ++i)
         {
             for(unsigned int j = i + 1; j < _num_vertices; ++j)
@@ -304,41 +337,46 @@ void CArchitect::buildConstraints()
                 const int remapped_j = remap_j(i, j);
                 for(unsigned int s = 0; s < _n[chr]; ++s)
                 {
-                    _model.add(_bar_y[chr][i][s]
-                               - _bar_y[chr][j][s]
-                               + 1
-                               - _x[i][remapped_j] >= 0);
-                    _model.add(_y[chr][i][s]
-                               - _d[chr][i][remapped_j][s]
-                               - e
-                               + e * _bar_y[chr][i][s]
-                               - e * _bar_y[chr][j][s]
-                               - e
-                               + e * _x[i][remapped_j] <= 0);
-                    _model.add(_y[chr][j][s]
-                               - _y[chr][i][s]
-                               + _d[chr][i][remapped_j][s]
-                               - _a[chr][i][remapped_j][s]
-                               - 4 * e
-                               + (2 * e) * _bar_y[chr][i][s]
-                               + (2 * e) * _bar_y[chr][j][s]
-                               - 2 * e
-                               + (2 * e) * _x[i][remapped_j] <= 0);
-                    _model.add(_y[chr][j][s]
-                               - _y[chr][i][s]
-                               + _d[chr][i][remapped_j][s]
-                               - _a[chr][i][remapped_j][s]
-                               + 4 * e
-                               - (2 * e) * _bar_y[chr][i][s]
-                               - (2 * e) * _bar_y[chr][j][s]
-                               + 2 * e
-                               - (2 * e) * _x[i][remapped_j] >= 0);
-                    _model.add(_d[chr][i][remapped_j][s]
-                               - _y[chr][i][s]
-                               + 1
-                               - (e + 1) * 2
-                               + (e + 1) * _bar_y[chr][i][s]
-                               + (e + 1) * _bar_y[chr][j][s] <= 0);
+                    const int M_del = _ub_y[chr][i][s];
+                    const int M_diff = std::max(1, std::max(_ub_y[chr][j][s] - _lb_y[chr][i][s] + _ub_d[chr][i],
+                                                            _ub_y[chr][i][s] - _lb_y[chr][j][s] + _ub_a[chr][j]));
+                    const int M_nonzero = _ub_d[chr][i] - _lb_y[chr][i][s] + 1;
+
+                    addArcRow(_bar_y[chr][i][s]
+                              - _bar_y[chr][j][s]
+                              + 1
+                              - _x[i][remapped_j] >= 0);
+                    addArcRow(_y[chr][i][s]
+                              - _d[chr][i][remapped_j][s]
+                              - M_del
+                              + M_del * _bar_y[chr][i][s]
+                              - M_del * _bar_y[chr][j][s]
+                              - M_del
+                              + M_del * _x[i][remapped_j] <= 0);
+                    addArcRow(_y[chr][j][s]
+                              - _y[chr][i][s]
+                              + _d[chr][i][remapped_j][s]
+                              - _a[chr][i][remapped_j][s]
+                              - 2 * M_diff
+                              + M_diff * _bar_y[chr][i][s]
+                              + M_diff * _bar_y[chr][j][s]
+                              - M_diff
+                              + M_diff * _x[i][remapped_j] <= 0);
+                    addArcRow(_y[chr][j][s]
+                              - _y[chr][i][s]
+                              + _d[chr][i][remapped_j][s]
+                              - _a[chr][i][remapped_j][s]
+                              + 2 * M_diff
+                              - M_diff * _bar_y[chr][i][s]
+                              - M_diff * _bar_y[chr][j][s]
+                              + M_diff
+                              - M_diff * _x[i][remapped_j] >= 0);
+                    addArcRow(_d[chr][i][remapped_j][s]
+                              - _y[chr][i][s]
+                              + 1
+                              - M_nonzero * 2
+                              + M_nonzero * _bar_y[chr][i][s]
+                              + M_nonzero * _bar_y[chr][j][s] <= 0);
                 }
             }
         }
@@ -346,7 +384,6 @@ void CArchitect::buildConstraints()
 
     for(unsigned int chr = 0; chr < _numChr; ++chr)
     {
-        const int e = *max_element(_e[chr].begin(), _e[chr].end());
         for(unsigned int i = 0; i < (_k - 1); ++i)
         {
             for(unsigned j = (i + 1); j < _num_vertices; ++j)
@@ -356,23 +393,23 @@ void CArchitect::buildConstraints()
                 {
                     if(l == 0)
                     {
-                        _model.add(_bar_a[chr][i][remapped_j][l] - _a[chr][i][remapped_j][l] >= 0);
-                        _model.add(_bar_d[chr][i][remapped_j][l] - _d[chr][i][remapped_j][l] >= 0);
+                        addArcRow(_bar_a[chr][i][remapped_j][l] - _a[chr][i][remapped_j][l] >= 0);
+                        addArcRow(_bar_d[chr][i][remapped_j][l] - _d[chr][i][remapped_j][l] >= 0);
                     }
                     else
                     {
-                        _model.add(_bar_a[chr][i][remapped_j][l] - _a[chr][i][remapped_j][l] + _a[chr][i][remapped_j][l-1] >= 0);
-                        _model.add(_bar_d[chr][i][remapped_j][l] - _d[chr][i][remapped_j][l] + _d[chr][i][remapped_j][l-1] >= 0);
+                        addArcRow(_bar_a[chr][i][remapped_j][l] - _a[chr][i][remapped_j][l] + _a[chr][i][remapped_j][l-1] >= 0);
+                        addArcRow(_bar_d[chr][i][remapped_j][l] - _d[chr][i][remapped_j][l] + _d[chr][i][remapped_j][l-1] >= 0);
                     }
 
                     _model.add(_a[chr][i][remapped_j][l]
-                               - e * _x[i][remapped_j] <= 0);
+                               - _ub_a[chr][j] * _x[i][remapped_j] <= 0);
                     _model.add(_d[chr][i][remapped_j][l]
-                               - e * _x[i][remapped_j] <= 0);
+                               - _ub_d[chr][i] * _x[i][remapped_j] <= 0);
                     _model.add(_bar_a[chr][i][remapped_j][l]
-                               - _e[chr][l] * _x[i][remapped_j] <= 0);
+                               - std::min(_e[chr][l], _ub_a[chr][j]) * _x[i][remapped_j] <= 0);
                     _model.add(_bar_d[chr][i][remapped_j][l]
-                               - _e[chr][l] * _x[i][remapped_j] <= 0);
+                               - std::min(_e[chr][l], _ub_d[chr][i]) * _x[i][remapped_j] <= 0);
                 }
             }
         }
@@ -381,7 +418,8 @@ void CArchitect::buildConstraints()
 
 HotStart CArchitect::firstCompleteHotStart(const InputInstance& inputInstance,
                                            const IntMatrix& e,
-                                           const unsigned int k)
+                                           const unsigned int k,
+                                           const bool symmetryBreaking)
 {
     DoubleMatrix M(inputInstance.m(), DoubleArray(k, 0.0));
     for(unsigned int p = 0; p < inputInstance.m(); ++p)
@@ -391,10 +429,8 @@ HotStart CArchitect::firstCompleteHotStart(const InputInstance& inputInstance,
 
     const int Z = 0;
 
-    g_mutex.lock();
     CArchitect architect(inputInstance, M, e, Z, k, false, true);
-    g_mutex.unlock();
-    
+    architect.setSymmetryBreaking(symmetryBreaking);
     architect.init();
     architect.solve(0, 0, 1);
 
@@ -22,7 +22,11 @@ public:
     /// Get solution cost
     int getDelta();
 
-    static HotStart firstCompleteHotStart(const InputInstance& inputInstance, const IntMatrix& e, const unsigned int k);
+    /// Replace the maximum number of events, only the budget row is updated
+    void updateZ(const int Z);
+
+    static HotStart firstCompleteHotStart(const InputInstance& inputInstance, const IntMatrix& e, const unsigned int k,
+                                          const bool symmetryBreaking);
 
 protected:
     /// TODO
@@ -39,7 +43,15 @@ protected:
     IloIntVar4Array _bar_a;
     /// TODO
     IloIntVar4Array _bar_d;
+    /// Budget constraint sum_bars <= Z
+    IloRange _budget;
+    /// Upper bound on the amplifications of the arcs into each vertex per chromosome
+    IntMatrix _ub_a;
+    /// Upper bound on the deletions of the arcs out of each vertex per chromosome
+    IntMatrix _ub_d;
 
+    /// Derive bounds on the variables before the model is built
+    void tightenBounds();
     /// Build variables
     void buildVariables();
     /// Build constraints
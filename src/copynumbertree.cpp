@@ -6,12 +6,11 @@ CopyNumberTree::CopyNumberTree()
     , _num_chr(0)
     , _n(0)
     , _numVertices(0)
-    , _T()
-    , _arcLookUp(_T)
-    , _node2idx(_T)
-    , _idx2node(_numVertices, lemon::INVALID)
-    , _profile(_T)
-    , _events(_T)
+    , _parent()
+    , _child()
+    , _profile()
+    , _events()
+    , _eventTarget()
     , _numEvents(0)
 {
 }
@@ -21,106 +20,154 @@ CopyNumberTree::CopyNumberTree(int k, int num_chr, const IntArray& n)
     , _num_chr(num_chr)
     , _n(n)
     , _numVertices(2*k - 1)
-    , _T()
-    , _arcLookUp(_T)
-    , _node2idx(_T)
-    , _idx2node(_numVertices, lemon::INVALID)
-    , _profile(_T)
-    , _events(_T)
+    , _parent()
+    , _child()
+    , _profile()
+    , _events()
+    , _eventTarget()
     , _numEvents(0)
 {
     init();
 }
 
-CopyNumberTree::CopyNumberTree(const CopyNumberTree &other)
-    : _k(other._k)
-    , _num_chr(other._num_chr)
-    , _n(other._n)
-    , _numVertices(other._numVertices)
-    , _T()
-    , _arcLookUp(_T)
-    , _node2idx(_T)
-    , _idx2node(other._idx2node.size(), lemon::INVALID)
-    , _profile(_T)
-    , _events(_T)
-    , _numEvents(0)
+const IntRaggedArray CopyNumberTree::getLeafProfiles() const
 {
-    lemon::digraphCopy(other._T, _T)
-            .nodeMap(other._node2idx, _node2idx)
-            .nodeMap(other._profile, _profile)
-            .arcMap(other._events, _events)
-            .run();
-    _numEvents = other._numEvents;
+    // the leaves are the last k rows of every chromosome
+    IntRaggedArray C(_n, _k);
+    for (int c = 0; c < _num_chr; ++c)
+    {
+        for (int l = 0; l < _k; ++l)
+        {
+            const IntRaggedArray::RowView<const int> y_i = _profile[c][_k - 1 + l];
+            std::copy(y_i.begin(), y_i.end(), C[c][l].begin());
+        }
+    }
 
-    for (NodeIt v(_T); v != lemon::INVALID; ++v)
+    return C;
+}
+
+CopyNumberTree::ProfileVector CopyNumberTree::profile(int i) const
+{
+    assert(0 <= i && i < _numVertices);
+    ProfileVector y_i(_num_chr);
+    for (int chr = 0; chr < _num_chr; ++chr)
     {
-        int idx = _node2idx[v];
-        _idx2node[idx] = v;
+        const IntRaggedArray::RowView<const int> row = _profile[chr][i];
+        y_i[chr] = Profile(row.begin(), row.end());
     }
+    return y_i;
 }
 
-CopyNumberTree& CopyNumberTree::operator=(const CopyNumberTree& other)
+CopyNumberTree::EventVector CopyNumberTree::events(int i, int j) const
 {
-    if (&other != this)
-    {
-        _k = other._k;
-        _num_chr = other._num_chr;
-        _n = other._n;
-        _numVertices = other._numVertices;
-        _T.clear();
-        lemon::digraphCopy(other._T, _T)
-                .nodeMap(other._node2idx, _node2idx)
-                .nodeMap(other._profile, _profile)
-                .arcMap(other._events, _events)
-                .run();
-        _numEvents = other._numEvents;
-
-        _idx2node = NodeVector(_numVertices, lemon::INVALID);
-        for (NodeIt v(_T); v != lemon::INVALID; ++v)
+    assert(isArc(i, j));
+    EventVector result;
+    for (unsigned int l = 0; l < _events.size(); ++l)
+    {
+        if (_eventTarget[l] == j)
         {
-            int idx = _node2idx[v];
-            _idx2node[idx] = v;
+            result.push_back(_events[l]);
         }
     }
-    return *this;
+    return result;
 }
 
-const Int3Array CopyNumberTree::getLeafProfiles() const
+CopyNumberTree CopyNumberTree::expand(const IntMatrix& w) const
 {
-    Int3Array C(_num_chr);
-    for(unsigned int c = 0; c < _num_chr; ++c)
+    // first expanded segment of every segment
+    IntMatrix offset(_num_chr);
+    IntArray n(_num_chr);
+    for (int chr = 0; chr < _num_chr; ++chr)
+    {
+        assert(w[chr].size() == _n[chr]);
+        offset[chr] = IntArray(_n[chr] + 1, 0);
+        for (int s = 0; s < _n[chr]; ++s)
+        {
+            offset[chr][s+1] = offset[chr][s] + w[chr][s];
+        }
+        n[chr] = offset[chr][_n[chr]];
+    }
+
+    CopyNumberTree result(_k, _num_chr, n);
+
+    for (int chr = 0; chr < _num_chr; ++chr)
     {
         for (int i = 0; i < _numVertices; ++i)
         {
-            if(isLeaf(i))
+            for (int s = 0; s < _n[chr]; ++s)
             {
-                const ProfileVector& y_i = profile(i);
-                C[c].push_back(y_i[c]);
+                std::fill(result._profile[chr][i].begin() + offset[chr][s],
+                          result._profile[chr][i].begin() + offset[chr][s+1],
+                          _profile[chr][i][s]);
             }
         }
     }
 
-    return C;
+    // same order of insertion, such that the left and right children are kept
+    result._parent = _parent;
+    result._child = _child;
+    result._eventTarget = _eventTarget;
+    result._numEvents = _numEvents;
+    for (const Event& event : _events)
+    {
+        result._events.push_back(Event(event._chr,
+                                       offset[event._chr][event._s],
+                                       offset[event._chr][event._t+1] - 1,
+                                       event._b));
+    }
+
+    return result;
 }
 
-void CopyNumberTree::init()
+CopyNumberTree CopyNumberTree::insertDiploid(const IntArray& n, const IntMatrix& origin) const
 {
-    _T.clear();
-    _numVertices = 2*_k - 1;
-    _idx2node = NodeVector(_numVertices, lemon::INVALID);
-    
-    // 2k-1 vertices
-    for (int i = 0; i < _numVertices; ++i)
+    assert(origin.size() == _num_chr);
+
+    const int num_chr = n.size();
+    CopyNumberTree result(_k, num_chr, n);
+    for (int chr = 0; chr < num_chr; ++chr)
     {
-        Node v_i = _T.addNode();
-        _idx2node[i] = v_i;
-        _node2idx[v_i] = i;
-        _profile[v_i] = ProfileVector(_num_chr);
-        for (int chr = 0; chr < _num_chr; ++chr)
+        for (int i = 0; i < _numVertices; ++i)
         {
-            _profile[v_i][chr] = Profile(_n[chr], 0);
+            std::fill(result._profile[chr][i].begin(), result._profile[chr][i].end(), 2);
         }
     }
+    for (int chr = 0; chr < _num_chr; ++chr)
+    {
+        for (int i = 0; i < _numVertices; ++i)
+        {
+            std::copy(_profile[chr][i].begin(), _profile[chr][i].end(),
+                      result._profile[origin[chr][0]][i].begin() + origin[chr][1]);
+        }
+    }
+
+    // see expand
+    result._parent = _parent;
+    result._child = _child;
+    result._eventTarget = _eventTarget;
+    result._numEvents = _numEvents;
+    for (const Event& event : _events)
+    {
+        const int chr = origin[event._chr][0];
+        result._events.push_back(Event(chr,
+                                       origin[event._chr][1] + event._s,
+                                       origin[event._chr][1] + event._t,
+                                       event._b));
+    }
+
+    return result;
+}
+
+void CopyNumberTree::init()
+{
+    // 2k-1 vertices
+    _numVertices = 2*_k - 1;
+    _parent = IntArray(_numVertices, -1);
+    _child = IntArray(2 * _numVertices, -1);
+    _profile = IntRaggedArray(_n, _numVertices, 0);
+    _events.clear();
+    _eventTarget.clear();
+    _numEvents = 0;
 }
 
 std::ostream& operator<<(std::ostream& out, const CopyNumberTree& T)
@@ -137,7 +184,6 @@ std::ostream& operator<<(std::ostream& out, const CopyNumberTree& T)
     
     for (int i = 0; i < T._numVertices; ++i)
     {
-        const CopyNumberTree::ProfileVector& y_i = T.profile(i);
         out << i << " :";
         for (int chr = 0; chr < T._num_chr; ++chr)
         {
@@ -147,34 +193,31 @@ std::ostream& operator<<(std::ostream& out, const CopyNumberTree& T)
             }
             for (int s = 0; s < T._n[chr]; ++s)
             {
-                out << " " << y_i[chr][s];
+                out << " " << T._profile[chr][i][s];
             }
         }
         out << std::endl;
     }
     
+    // children in order of insertion, such that reading keeps them
     out << "#EDGES" << std::endl;
-    for (CopyNumberTree::ArcIt a_ij(T._T); a_ij != lemon::INVALID; ++a_ij)
+    for (int l = 0; l < 2 * T._numVertices; ++l)
     {
-        CopyNumberTree::Node v_i = T._T.source(a_ij);
-        CopyNumberTree::Node v_j = T._T.target(a_ij);
-        out << T._node2idx[v_i] << " -> " << T._node2idx[v_j] << std::endl;
+        if (T._child[l] != -1)
+        {
+            out << l / 2 << " -> " << T._child[l] << std::endl;
+        }
     }
     
     out << "#EVENTS" << std::endl;
-    for (CopyNumberTree::ArcIt a_ij(T._T); a_ij != lemon::INVALID; ++a_ij)
+    for (unsigned int l = 0; l < T._events.size(); ++l)
     {
-        CopyNumberTree::Node v_i = T._T.source(a_ij);
-        CopyNumberTree::Node v_j = T._T.target(a_ij);
-        
-        const CopyNumberTree::EventVector& events_ij = T._events[a_ij];
-        for (const CopyNumberTree::Event& event : events_ij)
-        {
-            out << event._chr << " "
-                << T._node2idx[v_i] << " " << T._node2idx[v_j] << " "
-                << event._s << " "
-                << event._t << " " << event._b << std::endl;
-        }
+        const CopyNumberTree::Event& event = T._events[l];
+        const int j = T._eventTarget[l];
+        out << event._chr << " "
+            << T._parent[j] << " " << j << " "
+            << event._s << " "
+            << event._t << " " << event._b << std::endl;
     }
     
     return out;
@@ -258,9 +301,7 @@ std::istream& operator>>(std::istream& in, CopyNumberTree& T)
                         }
                         else
                         {
-                            CopyNumberTree::Node v_i = T._idx2node[counter_vertices];
-                            T._profile[v_i][counter_chromosomes][counter_seg] = atoi(value.c_str());
-                            
+                            T._profile[counter_chromosomes][counter_vertices][counter_seg] = atoi(value.c_str());
                         }
                         ++counter_seg;
                     }
@@ -372,31 +413,17 @@ bool CopyNumberTree::isArc(int i, int j) const
 {
     assert(0 <= i && i < _numVertices);
     assert(0 <= j && j < _numVertices);
-    Node v_i = _idx2node[i];
-    Node v_j = _idx2node[j];
     
-    return _arcLookUp(v_i, v_j) != lemon::INVALID;
+    return _parent[j] == i;
 }
 
 int CopyNumberTree::parent(int i) const
 {
     assert(0 <= i && i < _numVertices);
 
-    Node v_i = _idx2node[i];
-    assert(v_i != lemon::INVALID);
-    
-    InArcIt a_ij(_T, v_i);
-    if (a_ij == lemon::INVALID)
-    {
-        // this can only be the case for root
-        assert(i == 0);
-        return -1;
-    }
-    else
-    {
-        Node v_pi_i = _T.source(a_ij);
-        return _node2idx[v_pi_i];
-    }
+    // this can only be -1 for the root
+    assert(_parent[i] != -1 || i == 0);
+    return _parent[i];
 }
 
 int CopyNumberTree::leftChild(int i) const
@@ -408,11 +435,8 @@ int CopyNumberTree::leftChild(int i) const
     }
     else
     {
-        Node v_i = _idx2node[i];
-        assert(v_i != lemon::INVALID);
-        OutArcIt a_ij(_T, v_i);
-        assert(a_ij != lemon::INVALID);
-        return _node2idx[_T.target(a_ij)];
+        assert(_child[2*i] != -1);
+        return _child[2*i];
     }
 }
 
@@ -425,13 +449,8 @@ int CopyNumberTree::rightChild(int i) const
     }
     else
     {
-        Node v_i = _idx2node[i];
-        assert(v_i != lemon::INVALID);
-        OutArcIt a_ij(_T, v_i);
-        assert(a_ij != lemon::INVALID);
-        ++a_ij;
-        assert(a_ij != lemon::INVALID);
-        return _node2idx[_T.target(a_ij)];
+        assert(_child[2*i + 1] != -1);
+        return _child[2*i + 1];
     }
 }
 
@@ -439,23 +458,30 @@ void CopyNumberTree::addArc(int i, int j)
 {
     assert(0 <= i && i < _numVertices);
     assert(0 <= j && j < _numVertices);
-    Node v_i = _idx2node[i];
-    Node v_j = _idx2node[j];
+    assert(_parent[j] == -1);
     
-    assert(v_i != lemon::INVALID);
-    assert(v_j != lemon::INVALID);
-    
-    _T.addArc(v_i, v_j);
+    if (_child[2*i] == -1)
+    {
+        _child[2*i] = j;
+    }
+    else
+    {
+        assert(_child[2*i + 1] == -1);
+        _child[2*i + 1] = j;
+    }
+    _parent[j] = i;
 }
 
 void CopyNumberTree::setProfile(int i, const ProfileVector& y_i)
 {
     assert(0 <= i && i < _numVertices);
+    assert(y_i.size() == _num_chr);
     
-    Node v_i = _idx2node[i];
-    assert(v_i != lemon::INVALID);
-    
-    _profile[v_i] = y_i;
+    for (int chr = 0; chr < _num_chr; ++chr)
+    {
+        assert(y_i[chr].size() == _n[chr]);
+        std::copy(y_i[chr].begin(), y_i[chr].end(), _profile[chr][i].begin());
+    }
 }
 
 void CopyNumberTree::addEvent(int chr, int i, int j, const Event& event)
@@ -466,17 +492,10 @@ void CopyNumberTree::addEvent(int chr, int i, int j, const Event& event)
     
     assert(0 <= event._s && event._s <= event._t && event._t < _n[chr]);
     assert(!isLeaf(i));
+    assert(isArc(i, j));
     
-    Node v_i = _idx2node[i];
-    Node v_j = _idx2node[j];
-    
-    assert(v_i != lemon::INVALID);
-    assert(v_j != lemon::INVALID);
-    
-    Arc a_ij = _arcLookUp(v_i, v_j);
-    assert(a_ij != lemon::INVALID);
-    
-    _events[a_ij].push_back(event);
+    _events.push_back(event);
+    _eventTarget.push_back(j);
 
     _numEvents += abs(event._b);
 }
@@ -485,11 +504,8 @@ void CopyNumberTree::writeDOT(std::ostream &out) const
 {
     out << "digraph T {" << std::endl;
     
-    for (NodeIt v_i(_T); v_i != lemon::INVALID; ++v_i)
+    for (int i = 0; i < _numVertices; ++i)
     {
-        const int i = _node2idx[v_i];
-        const ProfileVector& y_i = _profile[v_i];
-        
         out << "\t" << i << " [label=\"";
         
         bool first = true;
@@ -508,24 +524,22 @@ void CopyNumberTree::writeDOT(std::ostream &out) const
                 else
                     out << " ";
                 
-                out << y_i[chr][s];
+                out << _profile[chr][i][s];
             }
         }
         out << "\"]" << std::endl;
     }
     
-    for (ArcIt a_ij(_T); a_ij != lemon::INVALID; ++a_ij)
+    for (int j = 0; j < _numVertices; ++j)
     {
-        Node v_i = _T.source(a_ij);
-        Node v_j = _T.target(a_ij);
-        
-        const int i = _node2idx[v_i];
-        const int j = _node2idx[v_j];
+        const int i = _parent[j];
+        if (i == -1)
+            continue;
         
         out << "\t" << i << " -> " << j << " [label=\"";
         
         bool first = true;
-        for (const auto& event : _events[a_ij])
+        for (const auto& event : events(i, j))
         {
             if (first)
                 first = false;
@@ -539,11 +553,28 @@ void CopyNumberTree::writeDOT(std::ostream &out) const
     out << "}" << std::endl;
 }
 
+void CopyNumberTree::digraph(Digraph& T, NodeVector& idx2node) const
+{
+    T.clear();
+    idx2node = NodeVector(_numVertices, lemon::INVALID);
+    for (int i = 0; i < _numVertices; ++i)
+    {
+        idx2node[i] = T.addNode();
+    }
+    for (int l = 0; l < 2 * _numVertices; ++l)
+    {
+        if (_child[l] != -1)
+        {
+            T.addArc(idx2node[l / 2], idx2node[_child[l]]);
+        }
+    }
+}
+
 IntSetPair CopyNumberTree::splits(int i) const
 {
     IntSetPair splitSetPair;
     
-    leafSet(_idx2node[i], splitSetPair.first);
+    leafSet(i, splitSetPair.first);
     for (int i = _k - 1; i < 2 * _k - 1; ++i)
     {
         if (splitSetPair.first.count(i) == 0)
@@ -555,19 +586,20 @@ IntSetPair CopyNumberTree::splits(int i) const
     return splitSetPair;
 }
 
-void CopyNumberTree::leafSet(const Node v_i, IntSet& set) const
+void CopyNumberTree::leafSet(int i, IntSet& set) const
 {
-    const int i = _node2idx[v_i];
     if (isLeaf(i))
     {
         set.insert(i);
     }
     else
     {
-        for (OutArcIt a_ij(_T, v_i); a_ij != lemon::INVALID; ++a_ij)
+        for (int l = 2*i; l < 2*i + 2; ++l)
         {
-            Node v_j = _T.target(a_ij);
-            leafSet(v_j, set);
+            if (_child[l] != -1)
+            {
+                leafSet(_child[l], set);
+            }
         }
     }
 }
@@ -9,6 +9,11 @@
 #include <ostream>
 #include "basic_types.h"
 
+/// Binary tree on 2k-1 vertices, where 0 is the root and k-1, ..., 2k-2 are
+/// the leaves. The topology is stored as parent and child index arrays, the
+/// profiles of all vertices in one contiguous buffer and the events in a flat
+/// list, such that copies and moves are cheap. A LEMON digraph of the tree is
+/// only built on demand.
 class CopyNumberTree
 {
 public:
@@ -18,14 +23,8 @@ public:
     typedef std::vector<Node> NodeVector;
     typedef std::vector<int> Profile;
     typedef std::vector<Profile> ProfileVector;
-    typedef Digraph::NodeMap<ProfileVector> ProfileNodeMap;
-    typedef lemon::DynArcLookUp<Digraph> ArcLookUp;
     
     CopyNumberTree();
-
-    CopyNumberTree(const CopyNumberTree& other);
-
-    CopyNumberTree& operator=(const CopyNumberTree& other);
     
     CopyNumberTree(int k, int num_chr, const IntArray& n);
     
@@ -54,48 +53,55 @@ public:
     };
     
     typedef std::vector<Event> EventVector;
-    typedef Digraph::ArcMap<EventVector> EventVectorArcMap;
     
+
     bool isLeaf(int i) const;
     bool isArc(int i, int j) const;
     int parent(int i) const;
+    /// Child of i that was added first, -1 if there is none
     int leftChild(int i) const;
+    /// Child of i that was added second, -1 if there is none
     int rightChild(int i) const;
     
     void addArc(int i, int j);
     void setProfile(int i, const ProfileVector& y_i);
     void addEvent(int chr, int i, int j, const Event& event);
     
-    int index(Node v_i) const
-    {
-        assert(v_i != lemon::INVALID);
-        return _node2idx[v_i];
-    }
-    
-    const ProfileVector& profile(int i) const
+    ProfileVector profile(int i) const;
+
+    /// Copy number of vertex i at position s of chromosome chr
+    int copyNumber(int i, int chr, int s) const
     {
         assert(0 <= i && i < _numVertices);
-        Node v_i = _idx2node[i];
-        assert(v_i != lemon::INVALID);
-        return _profile[v_i];
+        return _profile[chr][i][s];
     }
 
-    const Int3Array getLeafProfiles() const;
+    const IntRaggedArray getLeafProfiles() const;
+
+    /// Events of the arc (i,j)
+    EventVector events(int i, int j) const;
+
+    /// Return the tree on the segmentation in which segment s of chromosome chr
+    /// stands for w[chr][s] consecutive segments
+    CopyNumberTree expand(const IntMatrix& w) const;
+
+    /// Return the tree on chromosomes with n segments, where chromosome chr of
+    /// this tree starts at segment origin[chr][1] of chromosome origin[chr][0]
+    /// and all other segments have copy number 2 in every vertex
+    CopyNumberTree insertDiploid(const IntArray& n, const IntMatrix& origin) const;
     
     void init();
     
     void writeDOT(std::ostream& out) const;
     
+    /// Build the LEMON digraph of the tree, idx2node maps every vertex to its node
+    void digraph(Digraph& T, NodeVector& idx2node) const;
+    
     const IntArray& n() const
     {
         return _n;
     }
     
-    const Digraph& T() const
-    {
-        return _T;
-    }
-    
     int k() const
     {
         return _k;
@@ -109,12 +115,9 @@ public:
     int cost() const
     {
         int res = 0;
-        for (ArcIt a_ij(_T); a_ij != lemon::INVALID; ++a_ij)
+        for (const Event& event : _events)
         {
-            for (const Event& event : _events[a_ij])
-            {
-                res += abs(event._b);
-            }
+            res += abs(event._b);
         }
         assert(res == _numEvents);
         return res;
@@ -132,15 +135,19 @@ private:
     int _num_chr;
     IntArray _n;
     int _numVertices;
-    Digraph _T;
-    ArcLookUp _arcLookUp;
-    IntNodeMap _node2idx;
-    NodeVector _idx2node;
-    ProfileNodeMap _profile;
-    EventVectorArcMap _events;
+    /// Parent of every vertex, -1 if there is none
+    IntArray _parent;
+    /// Children of vertex i at 2i and 2i+1 in order of insertion, -1 if there is none
+    IntArray _child;
+    /// Profiles indexed by [chr][vertex][s]
+    IntRaggedArray _profile;
+    /// Events of all arcs in order of insertion
+    EventVector _events;
+    /// Target vertex of the arc of every event
+    IntArray _eventTarget;
     int _numEvents;
     
-    void leafSet(const Node v_i, IntSet& leafSet) const;
+    void leafSet(int i, IntSet& leafSet) const;
 };
 
 std::ostream& operator<<(std::ostream& out, const CopyNumberTree& T);
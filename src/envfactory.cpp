@@ -0,0 +1,21 @@
+#include "envfactory.h"
+
+boost::once_flag EnvFactory::_initialized = BOOST_ONCE_INIT;
+
+IloEnv EnvFactory::create()
+{
+    boost::call_once(_initialized, &EnvFactory::initialize);
+    return IloEnv();
+}
+
+void EnvFactory::initialize()
+{
+    // root environment, alive until the process exits
+    static IloEnv root;
+
+    // also open the CPLEX library once from a single thread
+    IloModel model(root);
+    IloCplex cplex(model);
+    cplex.end();
+    model.end();
+}
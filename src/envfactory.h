@@ -0,0 +1,28 @@
+#ifndef _ENVFACTORY_H_
+#define _ENVFACTORY_H_
+
+#include <ilcplex/ilocplex.h>
+#include <boost/thread/once.hpp>
+
+ILOSTLBEGIN
+
+/// This class hands out CPLEX environments that can be created concurrently.
+/// The first environment of the process initializes the library (including
+/// the license check), which is not safe to do from several threads at once.
+/// It is therefore created exactly once and kept alive, after which new
+/// environments are created without any locking.
+class EnvFactory
+{
+public:
+    /// Return a new environment, the caller is responsible for ending it
+    static IloEnv create();
+
+private:
+    /// Create the root environment
+    static void initialize();
+
+    /// Guards the creation of the root environment
+    static boost::once_flag _initialized;
+};
+
+#endif // _ENVFACTORY_H_
@@ -22,6 +22,29 @@ FMCSolution::FMCSolution(const CopyNumberTree& tree, const DoubleMatrix& M, cons
 {
 }
 
+double FMCSolution::getObjValue() const
+{
+    const IntRaggedArray C = _tree.getLeafProfiles();
+
+    double result = 0.0;
+    for (int chr = 0; chr < _input.numChr(); ++chr)
+    {
+        for (int p = 0; p < _input.m(); ++p)
+        {
+            for (int s = 0; s < _input.n()[chr]; ++s)
+            {
+                double f = 0.0;
+                for (int i = 0; i < C.rows(); ++i)
+                {
+                    f += _M[p][i] * C[chr][i][s];
+                }
+                result += _input.w()[chr][s] * fabs(_input.F()[chr][p][s] - f);
+            }
+        }
+    }
+    return result;
+}
+
 void FMCSolution::writeDOT(std::ostream &out) const
 {
     out << "digraph FMC {" << std::endl;
@@ -34,6 +34,10 @@ public:
         return _input;
     }
 
+    /// Distance between the input frequencies and the mixture of the leaf
+    /// profiles by M, every segment counting as many times as its weight
+    double getObjValue() const;
+
     void writeDOT(std::ostream& out) const;
     
 private:
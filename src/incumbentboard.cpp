@@ -0,0 +1,50 @@
+#include "incumbentboard.h"
+
+IncumbentBoard::IncumbentBoard()
+    : _incumbent()
+{
+}
+
+
+bool IncumbentBoard::post(const double objValue, const int seedIdx, const HotStart& completeHotStart)
+{
+    std::shared_ptr<const Incumbent> current = std::atomic_load(&_incumbent);
+    if(current && !g_tol.less(objValue, current->_objValue))
+        return false;
+
+    // the record is only built once the distance is known to improve
+    std::shared_ptr<Incumbent> incumbent = std::make_shared<Incumbent>();
+    incumbent->_objValue = objValue;
+    incumbent->_seed = seedIdx;
+    incumbent->_completeHotStart = std::make_shared<const HotStart>(completeHotStart);
+
+    std::shared_ptr<const Incumbent> desired(incumbent);
+    while(!std::atomic_compare_exchange_weak(&_incumbent, &current, desired))
+    {
+        // current now holds the incumbent posted in the meantime
+        if(current && !g_tol.less(objValue, current->_objValue))
+            return false;
+    }
+    return true;
+}
+
+
+double IncumbentBoard::getObjValue() const
+{
+    std::shared_ptr<const Incumbent> current = std::atomic_load(&_incumbent);
+    return current ? current->_objValue : std::numeric_limits<double>::infinity();
+}
+
+
+int IncumbentBoard::getSeed() const
+{
+    std::shared_ptr<const Incumbent> current = std::atomic_load(&_incumbent);
+    return current ? current->_seed : -1;
+}
+
+
+std::shared_ptr<const HotStart> IncumbentBoard::getCompleteHotStart() const
+{
+    std::shared_ptr<const Incumbent> current = std::atomic_load(&_incumbent);
+    return current ? current->_completeHotStart : std::shared_ptr<const HotStart>();
+}
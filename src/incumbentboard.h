@@ -0,0 +1,47 @@
+#ifndef _INCUMBENTBOARD_H_
+#define _INCUMBENTBOARD_H_
+
+#include <memory>
+#include <limits>
+
+#include "basic_types.h"
+
+/// Best distance reached so far by the seeds running for the same value of Z,
+/// together with the complete HotStart of the C-step that led to it. Seeds
+/// post after every M-step and read it between steps without taking a lock:
+/// the incumbent is an immutable record behind an atomically swapped pointer.
+class IncumbentBoard
+{
+public:
+    IncumbentBoard();
+
+    /// Post the distance objValue of seed seedIdx, attained from the C-step
+    /// solution completeHotStart, return true if it became the incumbent
+    bool post(const double objValue, const int seedIdx, const HotStart& completeHotStart);
+
+    /// Distance of the incumbent, infinity if none has been posted
+    double getObjValue() const;
+
+    /// Seed of the incumbent, -1 if none has been posted
+    int getSeed() const;
+
+    /// Complete HotStart of the incumbent, null if none has been posted
+    std::shared_ptr<const HotStart> getCompleteHotStart() const;
+
+private:
+    struct Incumbent
+    {
+        /// Distance
+        double _objValue;
+        /// Seed that posted it
+        int _seed;
+        /// Complete HotStart of the C-step
+        std::shared_ptr<const HotStart> _completeHotStart;
+    };
+
+    /// Current incumbent, null if none, only accessed through the atomic
+    /// shared_ptr functions
+    std::shared_ptr<const Incumbent> _incumbent;
+};
+
+#endif // _INCUMBENTBOARD_H_
@@ -8,9 +8,172 @@ InputInstance::InputInstance()
     , _m(-1)
     , _num_chr(-1)
     , _n()
+    , _w()
+    , _origin()
+    , _diploidDistance(0.0)
+    , _numInputSegments(0)
 {
 }
 
+int InputInstance::numSegments() const
+{
+    int result = 0;
+    for (int chr = 0; chr < _num_chr; ++chr)
+    {
+        result += sum_of_elements(_w[chr]);
+    }
+    return result;
+}
+
+InputInstance InputInstance::removeDiploid(const double tol) const
+{
+    const lemon::Tolerance<double> tolerance(tol);
+
+    InputInstance result;
+    result._m = _m;
+    result._num_chr = 0;
+    result._diploidDistance = _diploidDistance;
+    result._numInputSegments = _numInputSegments;
+
+    Double3Array resultF;
+    for (int chr = 0; chr < _num_chr; ++chr)
+    {
+        int s = 0;
+        int offset = _origin[chr][1];
+        while (s < _n[chr])
+        {
+            bool diploid = true;
+            for (int p = 0; p < _m && diploid; ++p)
+            {
+                diploid = !tolerance.different(_F[chr][p][s], 2.0);
+            }
+
+            if (diploid)
+            {
+                // every vertex has copy number 2, so the fit is |F - 2| in every sample
+                for (int p = 0; p < _m; ++p)
+                {
+                    result._diploidDistance += _w[chr][s] * fabs(_F[chr][p][s] - 2.0);
+                }
+                offset += _w[chr][s];
+                ++s;
+                continue;
+            }
+
+            int t = s;
+            IntArray origin = {_origin[chr][0], offset};
+            DoubleMatrix F(_m);
+            IntArray w;
+            for (; t < _n[chr]; ++t)
+            {
+                bool diploid_t = true;
+                for (int p = 0; p < _m && diploid_t; ++p)
+                {
+                    diploid_t = !tolerance.different(_F[chr][p][t], 2.0);
+                }
+                if (diploid_t)
+                    break;
+
+                for (int p = 0; p < _m; ++p)
+                {
+                    F[p].push_back(_F[chr][p][t]);
+                }
+                w.push_back(_w[chr][t]);
+                offset += _w[chr][t];
+            }
+
+            resultF.push_back(F);
+            result._w.push_back(w);
+            result._n.push_back(t - s);
+            result._origin.push_back(origin);
+            ++result._num_chr;
+
+            s = t;
+        }
+    }
+
+    if (result._num_chr == 0)
+    {
+        return *this;
+    }
+
+    result._F = resultF;
+    return result;
+}
+
+InputInstance InputInstance::compress(const double tol) const
+{
+    InputInstance result;
+    result._m = _m;
+    result._num_chr = _num_chr;
+    result._origin = _origin;
+    result._diploidDistance = _diploidDistance;
+    result._numInputSegments = _numInputSegments;
+    result._n = IntArray(_num_chr, 0);
+    result._w = IntMatrix(_num_chr);
+    Double3Array resultF(_num_chr, DoubleMatrix(_m));
+
+    for (int chr = 0; chr < _num_chr; ++chr)
+    {
+        int s = 0;
+        while (s < _n[chr])
+        {
+            // extend the run starting at s as long as every sample stays within tol
+            int t = s + 1;
+            for (; t < _n[chr]; ++t)
+            {
+                bool within = true;
+                for (int p = 0; p < _m && within; ++p)
+                {
+                    within = fabs(_F[chr][p][t] - _F[chr][p][s]) <= tol;
+                }
+                if (!within)
+                    break;
+            }
+
+            int weight = 0;
+            DoubleArray sum(_m, 0.0);
+            for (int l = s; l < t; ++l)
+            {
+                weight += _w[chr][l];
+                for (int p = 0; p < _m; ++p)
+                {
+                    sum[p] += _w[chr][l] * _F[chr][p][l];
+                }
+            }
+
+            for (int p = 0; p < _m; ++p)
+            {
+                resultF[chr][p].push_back(sum[p] / weight);
+            }
+            result._w[chr].push_back(weight);
+            ++result._n[chr];
+
+            s = t;
+        }
+    }
+
+    result._F = resultF;
+    return result;
+}
+
+InputInstance InputInstance::chromosome(const int chr) const
+{
+    assert(0 <= chr && chr < _num_chr);
+
+    InputInstance result;
+    result._m = _m;
+    result._num_chr = 1;
+    result._F = _F.chromosome(chr);
+    result._n = IntArray(1, _n[chr]);
+    result._w = IntMatrix(1, _w[chr]);
+    result._origin = IntMatrix(1, _origin[chr]);
+    result._diploidDistance = 0;
+    result._numInputSegments = sum_of_elements(_w[chr]);
+
+    return result;
+}
+
 int InputInstance::e() const
 {
     int max_e = 0;
@@ -107,8 +270,11 @@ std::istream& operator>>(std::istream& in, InputInstance& instance)
     std::string line;
     std::string value;
     
-    instance._F.clear();
+    instance._F = DoubleRaggedArray();
     instance._n.clear();
+    instance._w.clear();
+    instance._origin.clear();
+    instance._diploidDistance = 0.0;
     
     std::getline(in, line, '\n'); //Skip the first line "#PARAMS"
     
@@ -142,15 +308,15 @@ std::istream& operator>>(std::istream& in, InputInstance& instance)
     }
     
     /** Allocate the cube containing the result **/
-    instance._F = Double3Array(instance._num_chr, DoubleMatrix(instance._m));
+    instance._F = DoubleRaggedArray(instance._n, instance._m);
+    instance._w = IntMatrix(instance._num_chr);
     
     for(unsigned int chr = 0; chr < instance._num_chr; ++chr)
     {
-        for(unsigned int sample = 0; sample < instance._m; ++sample)
-        {
-            instance._F[chr][sample] = DoubleArray(instance._n[chr]);
-        }
+        instance._w[chr] = IntArray(instance._n[chr], 1);
+        instance._origin.push_back({(int)chr, 0});
     }
+    instance._numInputSegments = sum_of_elements(instance._n);
     
     getline(in, line, '\n'); //Skip the line "#PROFILES"
     
@@ -14,7 +14,7 @@ public:
     friend std::ostream& operator<<(std::ostream& out, const InputInstance& instance);
     friend std::istream& operator>>(std::istream& in, InputInstance& instance);
     
-    const Double3Array& F() const
+    const DoubleRaggedArray& F() const
     {
         return _F;
     }
@@ -33,6 +33,49 @@ public:
     {
         return _n;
     }
+
+    /// Number of input segments represented by each segment
+    const IntMatrix& w() const
+    {
+        return _w;
+    }
+
+    /// Input chromosome and first input segment of each chromosome
+    const IntMatrix& origin() const
+    {
+        return _origin;
+    }
+
+    /// Distance of the removed diploid segments to the normal diploid
+    double diploidDistance() const
+    {
+        return _diploidDistance;
+    }
+
+    /// Total number of input segments over all chromosomes
+    int numSegments() const;
+
+    /// Number of segments of the instance that was read, including the
+    /// segments dropped by removeDiploid
+    int numInputSegments() const
+    {
+        return _numInputSegments;
+    }
+
+    /// Remove the segments whose fractional copy numbers equal 2 in every
+    /// sample up to the tolerance tol. Every maximal run of remaining segments
+    /// becomes a chromosome of its own, such that no event can span a removed
+    /// segment. If no segment remains the instance is returned unchanged.
+    InputInstance removeDiploid(const double tol) const;
+
+    /// Merge every run of adjacent segments whose fractional copy numbers differ
+    /// from those of the first segment of the run by at most tol in every sample.
+    /// A merged segment has the mean fractional copy numbers of its run and the
+    /// total weight of its run.
+    InputInstance compress(const double tol) const;
+
+    /// Return the instance that consists of chromosome chr only
+    InputInstance chromosome(const int chr) const;
     
     /// Extract maximum copy number from F
     int e() const;
@@ -40,10 +83,14 @@ public:
     IntArray z() const;
     
 private:
-    Double3Array _F;
+    DoubleRaggedArray _F;
     int _m;
     int _num_chr;
     IntArray _n;
+    IntMatrix _w;
+    IntMatrix _origin;
+    double _diploidDistance;
+    int _numInputSegments;
 };
 
 std::ostream& operator<<(std::ostream& out, const InputInstance& instance);
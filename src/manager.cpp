@@ -31,37 +31,59 @@ Manager::Manager(const InputInstance &inputInstance,
     , _nrSeeds(nrSeeds)
     , _nrWorkers(nrWorkers)
     , _nrILPthreads(nrILPthreads)
-    , _allM0()
+    , _baseSeed(g_rng())
     , _timeLimit(timeLimit)
     , _memoryLimit(memoryLimit)
     , _eps(eps)
-    , _sem(nrWorkers)
-    , _threadGroup()
     , _mutex()
+    , _seedCompleted()
+    , _nrPendingSeeds()
+    , _discardPending(false)
     , _bestObjValue()
     , _bestT()
     , _bestC()
     , _bestM()
+    , _bestSeed()
     , _bestZ(-1)
     , _firstCompleteHotStart()
     , _lastCompleteHotStart()
     , _isComputed()
+    , _isLaunched()
     , _norm(0)
     , _diploidCompleteHotStart()
     , _refinedTree()
     , _refinedObjValue()
+    , _pool()
+    , _speculative(false)
+    , _checkpointFilename()
+    , _resume(false)
+    , _isRestored()
+    , _cacheDirectory()
+    , _cache()
+    , _traceDirectory()
+    , _seedM()
+    , _symmetryBreaking(false)
+    , _lazyConstraints(false)
+    , _enumerateTopologies(false)
+    , _poolSize(0)
+    , _candidates()
+    , _terminationRatio(-1)
+    , _injectHotStarts(false)
+    , _boards()
+    , _patience(-1)
+    , _confirmations(-1)
+    , _waitingSeeds()
+    , _nrNonImproving()
+    , _nrConfirmed()
+    , _nrLaunchedSeeds()
+    , _nrHarvestedSeeds()
 {
-    for (int i = 0; i < _nrSeeds; ++i)
-    {
-        _allM0.push_back(build_random_M(_inputInstance.m(), _k, _size_bubbles));
-    }
-
     //_LZ = std::min(_LZ, _UZ);
 
-    _norm = countElements(_inputInstance.F());
-    assert(_norm == (sum_of_elements(_inputInstance.n()) * inputInstance.m()));
-
-    _diploidCompleteHotStart = CArchitect::firstCompleteHotStart(_inputInstance, _e, _k);
+    // normalize by the instance that was read, so that -t keeps its meaning
+    // when segments are merged or removed by the presolve
+    _norm = _inputInstance.numInputSegments() * _inputInstance.m();
+    assert(countElements(_inputInstance.F()) == (sum_of_elements(_inputInstance.n()) * inputInstance.m()));
 }
 
 
@@ -78,7 +100,13 @@ void Manager::runBinarySearch()
     if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
         std::cerr << timestamp() << "Computing the distance for the right-most value UZ=" << _UZ << " in the starting interval [LZ=" << lb << ", UZ=" << ub << "]" << std::endl;
 
-    computeDistance(_UZ);
+    if(_speculative)
+    {
+        if(!_isLaunched[_UZ])
+            launchDistance(_UZ);
+        speculate(lb, ub);
+    }
+    ensureDistance(_UZ);
 
     while((ub - lb) > 1)
     {        
@@ -89,8 +117,9 @@ void Manager::runBinarySearch()
         if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
             std::cerr << timestamp() << "Considering interval [LZ=" << lb << ", UZ=" << ub << "] with MZ=" << mid << std::endl;
 
-        if(!_isComputed[mid])
-            computeDistance(mid);
+        if(_speculative)
+            speculate(lb, ub);
+        ensureDistance(mid);
 
         if(isImproving(_bestObjValue[mid], _bestObjValue[_UZ]))
         {
@@ -118,8 +147,7 @@ void Manager::runBinarySearch()
         if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
             std::cerr << timestamp() << "Considering interval [LZ=" << lb << ", UZ=" << ub << "]" << std::endl;
 
-        if(!_isComputed[lb])
-            computeDistance(lb);
+        ensureDistance(lb);
 
         if(isImproving(_bestObjValue[lb], _bestObjValue[_UZ]))
         {
@@ -127,8 +155,7 @@ void Manager::runBinarySearch()
                 std::cerr << timestamp() << "The distance d(" << lb << ")=" << _bestObjValue[lb] << " is improved by " << "d(" << _UZ << ")="
                           << _bestObjValue[_UZ] << " with a total tolerance of " << (_eps * _norm) << std::endl;
 
-            if(!_isComputed[ub])
-                computeDistance(ub);
+            ensureDistance(ub);
 
             _bestZ = ub;
 
@@ -144,12 +171,13 @@ void Manager::runBinarySearch()
             std::cerr << timestamp() << "Considering interval [LZ=" << lb << ", UZ=" << ub << "]" << std::endl;
 
         assert(ub == lb);
-        if(!_isComputed[lb])
-            computeDistance(lb);
+        ensureDistance(lb);
 
         _bestZ = lb;
     }
 
+    discardPending();
+
     assert(_isComputed[_bestZ]);
     assert(_bestZ >= _LZ & _bestZ <= _UZ);
     if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
@@ -167,7 +195,8 @@ void Manager::runReverse()
     initialize();
 
     int Z = _UZ;
-    computeDistance(Z);
+    if(!_isComputed[Z])
+        computeDistance(Z);
 
     if(Z > _LZ)
     {
@@ -176,7 +205,8 @@ void Manager::runReverse()
                       << _bestObjValue[_UZ] << " with a total tolerance of " << (_eps * _norm) << std::endl;
 
             --Z;
-            computeDistance(Z, _diploidCompleteHotStart);
+            if(!_isComputed[Z])
+                computeDistance(Z, _diploidCompleteHotStart);
 
         } while(!isImproving(_bestObjValue[Z], _bestObjValue[_UZ]) && Z > _LZ);
         _bestZ = Z + 1;
@@ -199,10 +229,53 @@ void Manager::runIterative()
 
     initialize();
 
+    if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+        std::cerr << timestamp() << "Computing distances for Z in [LZ=" << _LZ << ", UZ=" << _UZ << "] with one chain per seed ";
+    if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+        std::cerr << "{";
+
+    // Seed i at Z only depends on seed i at Z-1, so every seed walks through
+    // all values of Z on its own and never waits for the other seeds
     for (int Z = _LZ; Z <= _UZ; ++Z)
     {
-        computeDistance(Z);
+        if(!_isRestored[Z])
+            lookupCache(Z);
+        _nrPendingSeeds[Z] = _isRestored[Z] ? 0 : _nrSeeds;
+        _nrLaunchedSeeds[Z] = _nrPendingSeeds[Z];
+    }
+    for (int i = 0; i < _nrSeeds; ++i)
+    {
+        _pool->submit(boost::bind(&Manager::runChain, this, _LZ, _UZ, i, previousCompleteHotStart(_LZ, i)));
+    }
+
+    // values of Z complete in increasing order in every chain
+    for (int Z = _LZ; Z <= _UZ; ++Z)
+    {
+        waitSeeds(Z);
+        _isLaunched[Z] = true;
+        _isComputed[Z] = true;
+
+        // a solution for Z-1 is also a solution for Z
+        if(Z > _LZ && !g_tol.less(_bestObjValue[Z], _bestObjValue[Z-1]))
+        {
+            _bestObjValue[Z] = _bestObjValue[Z-1];
+            _bestSeed[Z] = -1;
+            _bestT[Z] = _bestT[Z-1];
+            _bestC[Z] = _bestC[Z-1];
+            _bestM[Z] = _bestM[Z-1];
+            _lastCompleteHotStart[Z] = _lastCompleteHotStart[Z-1];
+        }
+
+        if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+            std::cerr << std::endl << timestamp() << "Distance with " << Z <<" maximum number of events is " << _bestObjValue[Z] << std::endl;
+
+        storeCache(Z);
+        saveCheckpoint();
     }
+    _pool->wait();
+
+    if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+        std::cerr << "} " << std::endl;
 
     int Z = _UZ;
     while(!isImproving(_bestObjValue[Z-1], _bestObjValue[_UZ]) && Z > _LZ)
@@ -222,7 +295,31 @@ void Manager::runIterative()
 }
 
 
-DoubleMatrix Manager::build_random_M(const int num_samples, const int num_leaves, const int size_bubbles)
+DoubleMatrix Manager::buildSeed(const int seedIdx) const
+{
+    // The stream of a seed only depends on -ss and on the seed index, such
+    // that seeds can be generated in any order and on any thread. It does
+    // not depend on Z: a seed starts from the same M0 for every Z, which
+    // keeps the hot start from Z-1 feasible and as good for the first C-step.
+    // The first seed may instead continue from a given usage matrix, e.g.
+    // the best one found with fewer leaves.
+    if(seedIdx == 0 && !_seedM.empty())
+    {
+        DoubleMatrix M0 = _seedM;
+        for (DoubleArray& M0_p : M0)
+        {
+            M0_p.resize(_k, 0.0);
+        }
+        return M0;
+    }
+
+    std::seed_seq seq{_baseSeed, static_cast<unsigned int>(seedIdx)};
+    std::mt19937 rng(seq);
+    return build_random_M(_inputInstance.m(), _k, _size_bubbles, rng);
+}
+
+
+DoubleMatrix Manager::build_random_M(const int num_samples, const int num_leaves, const int size_bubbles, std::mt19937& rng)
 {
     DoubleMatrix result;
 
@@ -231,19 +328,21 @@ DoubleMatrix Manager::build_random_M(const int num_samples, const int num_leaves
         std::uniform_int_distribution<int> uni(1, num_leaves);
 
         //const int num_parts = generator();
-        const int num_parts = std::max(uni(g_rng), uni(g_rng));
-        result.push_back(build_partition_vector(num_leaves, num_parts, size_bubbles));
+        const int first = uni(rng);
+        const int second = uni(rng);
+        const int num_parts = std::max(first, second);
+        result.push_back(build_partition_vector(num_leaves, num_parts, size_bubbles, rng));
     }
 
     return result;
 }
 
 
-DoubleArray Manager::build_partition_vector(const int num_leaves, const int num_parts, const int size_bubbles)
+DoubleArray Manager::build_partition_vector(const int num_leaves, const int num_parts, const int size_bubbles, std::mt19937& rng)
 {
     IntArray positions(num_leaves);
     std::iota(positions.begin(), positions.end(), 0);
-    std::shuffle(positions.begin(), positions.end(), g_rng);
+    std::shuffle(positions.begin(), positions.end(), rng);
 
     //std::uniform_int_distribution<int> uni(1, size_bubbles);
     std::uniform_int_distribution<> dist(0, size_bubbles);
@@ -251,7 +350,7 @@ DoubleArray Manager::build_partition_vector(const int num_leaves, const int num_
     DoubleArray bubbles;
     for(unsigned int i = 0; i < num_parts-1; ++i)
     {
-        bubbles.push_back((double)dist(g_rng)/(double)size_bubbles);
+        bubbles.push_back((double)dist(rng)/(double)size_bubbles);
     }
     std::sort(bubbles.begin(), bubbles.end());
 
@@ -311,15 +410,84 @@ DoubleMatrix Manager::build_random_M(int m, int k, double alpha)
 **/
 
 
-void Manager::runInstance(const int Z, const int seedIdx, const HotStart &inputCompleteHotStart)
+void Manager::runInstance(const int Z, const int seedIdx, const DoubleMatrix& M0, const HotStart &inputCompleteHotStart)
 {
+    {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        if(_discardPending)
+        {
+            _waitingSeeds[Z].clear();
+            --_nrPendingSeeds[Z];
+            _seedCompleted.notify_all();
+            return;
+        }
+    }
+
     Worker worker(_inputInstance, _k, _e, Z,
                   _forceDiploid, _rootNotFixed,
                   _iterConvergence, _maxIter,
                   _timeLimit, _memoryLimit, _nrILPthreads,
-                  _allM0[seedIdx], seedIdx,
+                  M0, seedIdx,
                   inputCompleteHotStart);
+    worker.setSymmetryBreaking(_symmetryBreaking);
+    worker.setLazyConstraints(_lazyConstraints);
+    worker.setEnumerateTopologies(_enumerateTopologies);
+    worker.setPoolSize(_poolSize);
+    worker.setTraceDirectory(_traceDirectory);
+    shareIncumbent(worker, Z);
+
+    solveInstance(worker, Z, seedIdx);
+}
+
+
+void Manager::launchWaitingSeed(const int Z, const double objValue)
+{
+    // compared to the best distance before this seed, with the tolerance -t
+    if(isImproving(_bestObjValue[Z], objValue))
+    {
+        _nrNonImproving[Z] = 0;
+        _nrConfirmed[Z] = 1;
+    }
+    else
+    {
+        ++_nrNonImproving[Z];
+        if(!isImproving(objValue, _bestObjValue[Z]))
+            ++_nrConfirmed[Z];
+    }
+
+    if(_waitingSeeds[Z].empty())
+        return;
+
+    if((_patience > 0 && _nrNonImproving[Z] >= _patience)
+       || (_confirmations > 0 && _nrConfirmed[Z] >= _confirmations))
+    {
+        if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+            std::cerr << ":skip(" << _waitingSeeds[Z].size() << "):";
+        _waitingSeeds[Z].clear();
+        return;
+    }
+
+    // the completing seed is still pending, so Z cannot be collected in between
+    ++_nrPendingSeeds[Z];
+    ++_nrLaunchedSeeds[Z];
+    _pool->submit(_waitingSeeds[Z].front());
+    _waitingSeeds[Z].pop_front();
+}
 
+
+void Manager::shareIncumbent(Worker& worker, const int Z)
+{
+    if(_terminationRatio <= 0 && !_injectHotStarts)
+        return;
+
+    worker.setIncumbentBoard(&_boards[Z]);
+    worker.setTerminationRatio(_terminationRatio);
+    worker.setInjectHotStarts(_injectHotStarts);
+}
+
+
+void Manager::solveInstance(Worker& worker, const int Z, const int seedIdx)
+{
     double objValue = 0;
     try{
       objValue = worker.solve();
@@ -333,49 +501,99 @@ void Manager::runInstance(const int Z, const int seedIdx, const HotStart &inputC
       std::exit(EXIT_FAILURE);
     }
 
+    // the results are moved out of the worker before taking the lock, such
+    // that the critical section only swaps them in; the replaced values are
+    // released after the lock
+    HotStart firstCompleteHotStart = worker.takeFirstCompleteHotStart();
+    std::vector<Worker::Candidate> candidates = worker.takeCandidates();
+    CopyNumberTree T = worker.takeT();
+    IntRaggedArray C = worker.takeC();
+    DoubleMatrix M = worker.takeM();
+    HotStart lastCompleteHotStart = worker.takeLastCompleteHotStart();
+
     {
         boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
 
         if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
             std::cerr << ":s(" << seedIdx << ")=" << objValue << ":";
 
-        _firstCompleteHotStart[Z][seedIdx] = worker.getFirstCompleteHotStart();
-        if (g_tol.less(objValue, _bestObjValue[Z]))
+        _firstCompleteHotStart[Z][seedIdx].swap(firstCompleteHotStart);
+        _candidates[Z][seedIdx].swap(candidates);
+        launchWaitingSeed(Z, objValue);
+        // seeds are compared exactly with ties broken by index, such that the
+        // result does not depend on the order in which the seeds complete
+        const bool improving = _bestSeed[Z] == -1
+                             ? g_tol.less(objValue, _bestObjValue[Z])
+                             : (objValue < _bestObjValue[Z] || (objValue == _bestObjValue[Z] && seedIdx < _bestSeed[Z]));
+        if (improving)
         {
             _bestObjValue[Z] = objValue;
-            _bestT[Z] = worker.getT();
-            _bestC[Z] = worker.getC();
-            _bestM[Z] = worker.getM();
-            _lastCompleteHotStart[Z] = worker.getLastCompleteHotStart();
-            _isComputed[Z] = true;
+            _bestSeed[Z] = seedIdx;
+            std::swap(_bestT[Z], T);
+            std::swap(_bestC[Z], C);
+            _bestM[Z].swap(M);
+            _lastCompleteHotStart[Z].swap(lastCompleteHotStart);
         }
+
+        --_nrPendingSeeds[Z];
     }
-    
-    _sem.post();
+    _seedCompleted.notify_all();
 }
 
 
-void Manager::computeDistance(const int Z)
+void Manager::runChain(const int LZ, const int UZ, const int seedIdx, const HotStart &inputCompleteHotStart)
 {
-    if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
-        std::cerr << timestamp() <<"Computing distance with " << Z << " maximum number of events ";
-    if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
-        std::cerr << "{";
-    assert(!_isComputed[Z]);
+    const DoubleMatrix M0 = buildSeed(seedIdx);
 
-    initializeZwithPrevious(Z);
+    // M0 does not depend on Z, so the chain keeps a single worker whose
+    // C-step model only gets the right-hand side of its budget row changed
+    std::unique_ptr<Worker> worker;
 
-    for (int i = 0; i < _nrSeeds; ++i)
+    const HotStart* completeHotStart = &inputCompleteHotStart;
+    for (int Z = LZ; Z <= UZ; ++Z)
     {
-        _sem.wait();
-        _threadGroup.create_thread(boost::bind(&Manager::runInstance, this, Z, i, previousCompleteHotStart(Z, i)));
+        // values read from the checkpoint or the cache only provide the hot start
+        if(!_isRestored[Z])
+        {
+            if(!worker)
+            {
+                worker.reset(new Worker(_inputInstance, _k, _e, Z,
+                                        _forceDiploid, _rootNotFixed,
+                                        _iterConvergence, _maxIter,
+                                        _timeLimit, _memoryLimit, _nrILPthreads,
+                                        M0, seedIdx,
+                                        *completeHotStart));
+                worker->setSymmetryBreaking(_symmetryBreaking);
+                worker->setLazyConstraints(_lazyConstraints);
+                worker->setEnumerateTopologies(_enumerateTopologies);
+                worker->setTraceDirectory(_traceDirectory);
+            }
+            else
+            {
+                worker->updateZ(Z, *completeHotStart);
+            }
+            shareIncumbent(*worker, Z);
+            solveInstance(*worker, Z, seedIdx);
+        }
+
+        // only this chain writes the hot starts of seedIdx
+        if(!_firstCompleteHotStart[Z][seedIdx].empty())
+        {
+            completeHotStart = &_firstCompleteHotStart[Z][seedIdx];
+        }
     }
-    _threadGroup.join_all();
+}
 
+
+void Manager::computeDistance(const int Z)
+{
     if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
-        std::cerr << "} ";
+        std::cerr << timestamp() <<"Computing distance with " << Z << " maximum number of events ";
     if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
-        std::cerr << std::endl << timestamp() << "Distance with " << Z <<" maximum number of events is " << _bestObjValue[Z] << std::endl;
+        std::cerr << "{";
+
+    launchDistance(Z);
+    finishDistance(Z);
 }
 
 
@@ -385,21 +603,248 @@ void Manager::computeDistance(const int Z, const HotStart &inputCompleteHotStart
         std::cerr << timestamp() << "Computing distance with " << Z << " maximum number of events ";
     if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
         std::cerr << "{";
-    assert(!_isComputed[Z]);
+    assert(!_isLaunched[Z]);
+
+    collectCompleted();
+    initializeZwithPrevious(Z);
+
+    if(!lookupCache(Z))
+    {
+        submitSeeds(Z, &inputCompleteHotStart);
+    }
+
+    finishDistance(Z);
+}
+
+
+void Manager::ensureDistance(const int Z)
+{
+    if(!_isLaunched[Z])
+    {
+        computeDistance(Z);
+    }
+    else if(!_isComputed[Z])
+    {
+        if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+            std::cerr << timestamp() << "Waiting for the speculative distance with " << Z << " maximum number of events {";
+
+        finishDistance(Z);
+    }
+}
+
 
+void Manager::launchDistance(const int Z)
+{
+    assert(!_isLaunched[Z]);
+
+    collectCompleted();
     initializeZwithPrevious(Z);
 
+    if(lookupCache(Z))
+        return;
+
+    submitSeeds(Z, NULL);
+}
+
+
+void Manager::submitSeeds(const int Z, const HotStart* inputCompleteHotStart)
+{
+    // the last seeds start from the best candidates harvested at the closest
+    // smaller Z, whose solutions remain feasible for Z
+    const std::vector<Worker::Candidate> candidates = harvestedCandidates(Z);
+    const int firstCandidate = _nrSeeds - candidates.size();
+
+    std::vector<ThreadPool::Task> seeds;
     for (int i = 0; i < _nrSeeds; ++i)
     {
-        _sem.wait();
-        _threadGroup.create_thread(boost::bind(&Manager::runInstance, this, Z, i, inputCompleteHotStart));
+        if(i >= firstCandidate)
+        {
+            const Worker::Candidate& candidate = candidates[i - firstCandidate];
+            seeds.push_back(boost::bind(&Manager::runInstance, this, Z, i,
+                                        candidate._M, candidate._completeHotStart));
+        }
+        else
+        {
+            seeds.push_back(boost::bind(&Manager::runInstance, this, Z, i, buildSeed(i),
+                                        inputCompleteHotStart ? *inputCompleteHotStart : previousCompleteHotStart(Z, i)));
+        }
+    }
+
+    // in adaptive mode only the seeds that fit on the pool are launched, every
+    // completed seed then launches the next one until a criterion is met
+    const bool adaptive = _patience > 0 || _confirmations > 0;
+    const int nrLaunched = adaptive ? std::min(_nrSeeds, _pool->size()) : _nrSeeds;
+
+    _isLaunched[Z] = true;
+    {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        _nrPendingSeeds[Z] = nrLaunched;
+        _nrLaunchedSeeds[Z] = nrLaunched;
+        _nrHarvestedSeeds[Z] = candidates.size();
+        _nrNonImproving[Z] = 0;
+        _nrConfirmed[Z] = 0;
+        _waitingSeeds[Z] = std::deque<ThreadPool::Task>(seeds.begin() + nrLaunched, seeds.end());
     }
-    _threadGroup.join_all();
+    for (int i = 0; i < nrLaunched; ++i)
+    {
+        _pool->submit(seeds[i]);
+    }
+}
+
+
+std::vector<Worker::Candidate> Manager::harvestedCandidates(const int Z) const
+{
+    std::vector<Worker::Candidate> result;
+    if(_poolSize <= 0)
+        return result;
+
+    int ctr = Z;
+    do {
+        --ctr;
+    } while(ctr >= 0 && !_isComputed[ctr]);
+
+    if(ctr < 0)
+        return result;
+
+    // seeds are merged by index and sorted stably, such that the result does
+    // not depend on the order in which the seeds completed
+    for (const std::vector<Worker::Candidate>& seedCandidates : _candidates[ctr])
+    {
+        result.insert(result.end(), seedCandidates.begin(), seedCandidates.end());
+    }
+    std::stable_sort(result.begin(), result.end());
+
+    // different seeds may harvest the same solution, which would start
+    // several seeds from the same M
+    std::vector<Worker::Candidate> distinct;
+    for (const Worker::Candidate& candidate : result)
+    {
+        bool duplicate = false;
+        for (const Worker::Candidate& other : distinct)
+        {
+            duplicate = duplicate || other._M == candidate._M;
+        }
+        if(!duplicate)
+            distinct.push_back(candidate);
+    }
+    result.swap(distinct);
+
+    // the first seed always remains
+    result.resize(std::min<size_t>(result.size(), std::min(_poolSize, _nrSeeds - 1)));
+    return result;
+}
+
+
+void Manager::finishDistance(const int Z)
+{
+    assert(_isLaunched[Z]);
+
+    waitSeeds(Z);
+    _isComputed[Z] = true;
 
     if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
         std::cerr << "} ";
     if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
         std::cerr << std::endl << timestamp() << "Distance with " << Z <<" maximum number of events is " << _bestObjValue[Z] << std::endl;
+
+    storeCache(Z);
+    saveCheckpoint();
+}
+
+
+void Manager::speculate(const int lb, const int ub)
+{
+    // Number of Z values whose seeds can run side by side
+    const int budget = std::max(1, _nrWorkers / _nrSeeds);
+
+    collectCompleted();
+
+    int nrRunning = 0;
+    for (int Z = _LZ; Z <= _UZ; ++Z)
+    {
+        if(_isLaunched[Z] && !_isComputed[Z])
+            ++nrRunning;
+    }
+
+    // Walk the binary search tree below [lb, ub] level by level and launch
+    // the midpoints that the search may need next
+    std::deque<std::pair<int, int> > intervals;
+    intervals.push_back(std::make_pair(lb, ub));
+    while(!intervals.empty() && nrRunning < budget)
+    {
+        const int l = intervals.front().first;
+        const int u = intervals.front().second;
+        intervals.pop_front();
+
+        if(u - l < 1)
+            continue;
+
+        const int mid = (u - l == 1) ? l : std::ceil(((double)u + (double)l)/2.0);
+        if(!_isLaunched[mid])
+        {
+            if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+                std::cerr << timestamp() << "Speculatively launching the distance with " << mid << " maximum number of events" << std::endl;
+
+            launchDistance(mid);
+            ++nrRunning;
+        }
+
+        if(u - l > 1)
+        {
+            intervals.push_back(std::make_pair(mid, u));
+            intervals.push_back(std::make_pair(l, mid));
+        }
+    }
+}
+
+
+void Manager::collectCompleted()
+{
+    IntArray collected;
+    {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        for (int Z = _LZ; Z <= _UZ; ++Z)
+        {
+            if(_isLaunched[Z] && !_isComputed[Z] && _nrPendingSeeds[Z] == 0)
+            {
+                _isComputed[Z] = true;
+                collected.push_back(Z);
+            }
+        }
+    }
+
+    for (int Z : collected)
+    {
+        storeCache(Z);
+    }
+    if(!collected.empty())
+    {
+        saveCheckpoint();
+    }
+}
+
+
+void Manager::discardPending()
+{
+    {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        _discardPending = true;
+    }
+    _pool->wait();
+    {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        _discardPending = false;
+    }
+}
+
+
+void Manager::waitSeeds(const int Z)
+{
+    boost::unique_lock<boost::mutex> lock(_mutex);
+    while(_nrPendingSeeds[Z] > 0)
+    {
+        _seedCompleted.wait(lock);
+    }
 }
 
 
@@ -411,12 +856,12 @@ const HotStart& Manager::previousCompleteHotStart(const int Z, const int seedIdx
         --ctr;
     } while(ctr >= 0 && !_isComputed[ctr]);
 
-    if(ctr >= 0)
+    // seeds that were not launched in adaptive mode have no hot start
+    if(ctr >= 0 && !_firstCompleteHotStart[ctr][seedIdx].empty())
     {
         assert(_isComputed[ctr]);
         return _firstCompleteHotStart[ctr][seedIdx];
     } else {
-        assert(ctr == -1);
         return _diploidCompleteHotStart;
     }
 }
@@ -434,11 +879,39 @@ void Manager::initialize()
 
     _bestObjValue = DoubleArray(size, std::numeric_limits<double>::max());
     _bestT = std::vector<CopyNumberTree>(size);
-    _bestC = Int4Array(size);
+    _bestC = std::vector<IntRaggedArray>(size);
     _bestM = Double3Array(size);
+    _bestSeed = IntArray(size, -1);
     _firstCompleteHotStart = std::vector<std::vector<HotStart> >(size, std::vector<HotStart> (_nrSeeds));
+    _candidates = std::vector<std::vector<std::vector<Worker::Candidate> > >(size, std::vector<std::vector<Worker::Candidate> >(_nrSeeds));
     _lastCompleteHotStart = std::vector<HotStart>(size);
     _isComputed = std::vector<bool>(size, false);
+    _isLaunched = std::vector<bool>(size, false);
+    _nrPendingSeeds = IntArray(size, 0);
+    _isRestored = std::vector<bool>(size, false);
+    _boards = std::vector<IncumbentBoard>(size);
+    _waitingSeeds = std::vector<std::deque<ThreadPool::Task> >(size);
+    _nrNonImproving = IntArray(size, 0);
+    _nrConfirmed = IntArray(size, 0);
+    _nrLaunchedSeeds = IntArray(size, 0);
+    _nrHarvestedSeeds = IntArray(size, 0);
+
+    // the hot starts of the C-step must satisfy the same symmetry-breaking constraints
+    _diploidCompleteHotStart = CArchitect::firstCompleteHotStart(_inputInstance, _e, _k, _symmetryBreaking);
+
+    if(!_pool)
+    {
+        _pool = std::make_shared<ThreadPool>(_nrWorkers);
+    }
+    if(!_cacheDirectory.empty())
+    {
+        _cache = ResultCache(_cacheDirectory, cacheKey());
+    }
+
+    if(_resume)
+    {
+        loadCheckpoint();
+    }
 
     if (g_verbosity >= VerbosityLevel::VERBOSE_NON_ESSENTIAL)
         std::cout << "k" << "\t" << "Z" << "\t" << "seed" << "\t"
@@ -461,11 +934,11 @@ void Manager::initializeZwithPrevious(const int Z)
         assert(_isComputed[ctr]);
 
         _bestObjValue[Z] = _bestObjValue[ctr];
+        _bestSeed[Z] = -1;
         _bestT[Z] = _bestT[ctr];
         _bestC[Z] = _bestC[ctr];
         _bestM[Z] = _bestM[ctr];
         _lastCompleteHotStart[Z] = _lastCompleteHotStart[ctr];
-        _isComputed[Z] = true;
 
         if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
             std::cerr << "previousBest=" << _bestObjValue[Z] << ":";
@@ -516,3 +989,233 @@ void Manager::refinement()
         _refinedTree = _bestT[_bestZ];
     }
 }
+
+
+void Manager::saveCheckpoint()
+{
+    if(_checkpointFilename.empty())
+        return;
+
+    // Only the main thread writes the checkpoint, once a value of Z is
+    // computed, so two snapshots are never written at the same time
+
+    // Copy the computed values of Z such that the seeds of other values
+    // are not blocked while the file is written
+    std::vector<std::pair<int, ResultCache::Entry> > entries;
+    {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        for (int Z = 0; Z <= _UZ; ++Z)
+        {
+            if(_isComputed[Z])
+                entries.push_back(std::make_pair(Z, getEntry(Z)));
+        }
+    }
+
+    // Write to a temporary file first such that an interrupted run never
+    // leaves a truncated checkpoint behind
+    const std::string tmpFilename = _checkpointFilename + ".tmp";
+    std::ofstream out(tmpFilename.c_str());
+    if(!out.good())
+    {
+        throw std::runtime_error("ERROR: cannot write checkpoint " + tmpFilename);
+    }
+
+    out << "#CHECKPOINT" << std::endl;
+    out << _k << " " << _inputInstance.m() << " " << _inputInstance.numChr() << " "
+        << _nrSeeds << " " << _baseSeed << " " << ResultCache::hash(cacheKey()) << std::endl;
+
+    for (const std::pair<int, ResultCache::Entry>& entry : entries)
+    {
+        out << "#Z " << entry.first << std::endl;
+        ResultCache::write(out, entry.second);
+    }
+    out << "#END" << std::endl;
+    out.close();
+
+    if(std::rename(tmpFilename.c_str(), _checkpointFilename.c_str()) != 0)
+    {
+        throw std::runtime_error("ERROR: cannot write checkpoint " + _checkpointFilename);
+    }
+}
+
+
+void Manager::loadCheckpoint()
+{
+    std::ifstream in(_checkpointFilename.c_str());
+    if(!in.good())
+    {
+        // nothing to resume from, e.g. the previous run did not compute any Z yet
+        if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+            std::cerr << timestamp() << "No checkpoint found at " << _checkpointFilename << ", starting from scratch" << std::endl;
+        return;
+    }
+
+    std::string line;
+    std::getline(in, line);
+    if(line != "#CHECKPOINT")
+    {
+        throw std::runtime_error("ERROR: " + _checkpointFilename + " is not a checkpoint");
+    }
+
+    unsigned int k = 0, baseSeed = 0;
+    int m = 0, numChr = 0, nrSeeds = 0;
+    std::string hash;
+    in >> k >> m >> numChr >> nrSeeds >> baseSeed >> hash;
+    if(k != _k || m != _inputInstance.m() || numChr != _inputInstance.numChr())
+    {
+        throw std::runtime_error("ERROR: checkpoint " + _checkpointFilename + " does not match the input instance");
+    }
+    if(nrSeeds != _nrSeeds || baseSeed != _baseSeed)
+    {
+        throw std::runtime_error("ERROR: checkpoint " + _checkpointFilename + " was written with different seeds (-s and -ss)");
+    }
+    // the same hash as the cache, covering F, the weights, e and every parameter of the seeds
+    if(hash != ResultCache::hash(cacheKey()))
+    {
+        throw std::runtime_error("ERROR: checkpoint " + _checkpointFilename + " was written for a different instance or different parameters");
+    }
+
+    std::string tag;
+    while(in >> tag && tag != "#END")
+    {
+        if(tag != "#Z")
+        {
+            throw std::runtime_error("ERROR: unexpected " + tag + " in checkpoint " + _checkpointFilename);
+        }
+
+        int Z = 0;
+        in >> Z;
+
+        ResultCache::Entry entry;
+        try {
+            ResultCache::read(in, entry);
+        } catch (const std::runtime_error& ex) {
+            throw std::runtime_error("ERROR: checkpoint " + _checkpointFilename + " is malformed");
+        }
+
+        // values of Z outside of the current range are of no use
+        if(Z < 0 || Z > _UZ)
+            continue;
+
+        restoreEntry(Z, entry);
+
+        if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+            std::cerr << timestamp() << "Resumed distance with " << Z << " maximum number of events is " << _bestObjValue[Z] << std::endl;
+    }
+}
+
+
+std::string Manager::cacheKey() const
+{
+    // Everything that determines the outcome of the seeds for a given Z, the
+    // number of workers only matters when it decides which seeds are launched.
+    // The search mode and the tolerance are deliberately left out: they decide
+    // which Z are evaluated, but also which smaller Z a value inherits its
+    // starting distance and hot starts from, so reusing a value across them
+    // is an approximation. The thread and memory limits are left out as well.
+    std::stringstream key;
+    key.precision(std::numeric_limits<double>::max_digits10);
+
+    key << "#VERSION 1" << std::endl;
+    key << _inputInstance;
+    key << "#W" << std::endl;
+    for (const IntArray& w_chr : _inputInstance.w())
+    {
+        for (int value : w_chr)
+            key << value << " ";
+        key << std::endl;
+    }
+    key << "#E" << std::endl;
+    for (const IntArray& e_chr : _e)
+    {
+        for (int value : e_chr)
+            key << value << " ";
+        key << std::endl;
+    }
+    key << "#PARAMS" << std::endl;
+    key << _k << " " << _forceDiploid << " " << _rootNotFixed << " "
+        << _size_bubbles << " " << _iterConvergence << " " << _maxIter << " "
+        << _nrSeeds << " " << _baseSeed << " " << _timeLimit << " " << _symmetryBreaking << " " << _enumerateTopologies << " " << _poolSize << " " << _lazyConstraints << " " << _terminationRatio << " " << _injectHotStarts << " " << _patience << " " << _confirmations << " " << _speculative << " "
+        << (_patience > 0 || _confirmations > 0 ? _nrWorkers : 0) << std::endl;
+    if(!_seedM.empty())
+    {
+        key << "#SEEDM" << std::endl;
+        for (const DoubleArray& M_p : _seedM)
+        {
+            for (double value : M_p)
+                key << value << " ";
+            key << std::endl;
+        }
+    }
+
+    return key.str();
+}
+
+
+ResultCache::Entry Manager::getEntry(const int Z) const
+{
+    ResultCache::Entry entry;
+    entry._objValue = _bestObjValue[Z];
+    entry._bestSeed = _bestSeed[Z];
+    entry._T = _bestT[Z];
+    entry._C = _bestC[Z];
+    entry._M = _bestM[Z];
+    entry._firstCompleteHotStart = _firstCompleteHotStart[Z];
+    entry._lastCompleteHotStart = _lastCompleteHotStart[Z];
+    return entry;
+}
+
+
+void Manager::restoreEntry(const int Z, const ResultCache::Entry& entry)
+{
+    if(entry._firstCompleteHotStart.size() != static_cast<size_t>(_nrSeeds))
+    {
+        throw std::runtime_error("ERROR: restored solution has a different number of seeds");
+    }
+
+    _firstCompleteHotStart[Z] = entry._firstCompleteHotStart;
+
+    // keep the solution inherited from a smaller Z if it is as good
+    if(g_tol.less(entry._objValue, _bestObjValue[Z]))
+    {
+        _bestObjValue[Z] = entry._objValue;
+        _bestSeed[Z] = entry._bestSeed;
+        _bestT[Z] = entry._T;
+        _bestC[Z] = entry._C;
+        _bestM[Z] = entry._M;
+        _lastCompleteHotStart[Z] = entry._lastCompleteHotStart;
+    }
+
+    _isLaunched[Z] = true;
+    _isComputed[Z] = true;
+    _isRestored[Z] = true;
+}
+
+
+bool Manager::lookupCache(const int Z)
+{
+    ResultCache::Entry entry;
+    if(!_cache.lookup(Z, entry) || entry._firstCompleteHotStart.size() != static_cast<size_t>(_nrSeeds))
+        return false;
+
+    restoreEntry(Z, entry);
+
+    if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+        std::cerr << "cached=" << _bestObjValue[Z] << ":";
+
+    return true;
+}
+
+
+void Manager::storeCache(const int Z)
+{
+    if(!_cache.enabled() || _isRestored[Z])
+        return;
+
+    ResultCache::Entry entry;
+    {
+        boost::interprocess::scoped_lock<boost::mutex> lock(_mutex);
+        entry = getEntry(Z);
+    }
+    _cache.store(Z, entry);
+}
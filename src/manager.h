@@ -6,15 +6,20 @@
 #include "copynumbertree.h"
 #include "worker.h"
 #include "refiner.h"
+#include "threadpool.h"
+#include "resultcache.h"
+#include "incumbentboard.h"
 
 #include <boost/random/variate_generator.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int.hpp>
 #include <boost/math/distributions.hpp>
 #include <boost/math/distributions/gamma.hpp>
-#include <boost/interprocess/sync/interprocess_semaphore.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/thread.hpp>
+#include <memory>
+#include <fstream>
+#include <cstdio>
 
 
 class Manager
@@ -46,9 +51,86 @@ public:
     /// Run with the iterative mode from LB to UB
     void runIterative();
     /// Construct random M
-    static DoubleMatrix build_random_M(const int num_samples, const int num_leaves, const int size_bubbles);
+    static DoubleMatrix build_random_M(const int num_samples, const int num_leaves, const int size_bubbles, std::mt19937& rng);
     /// Construct random vector summing up to 1
-    static DoubleArray build_partition_vector(const int num_leaves, const int num_parts, const int size_bubbles);
+    static DoubleArray build_partition_vector(const int num_leaves, const int num_parts, const int size_bubbles, std::mt19937& rng);
+    /// Evaluate the next midpoints of the binary search on idle workers
+    void setSpeculative(const bool speculative)
+    {
+        _speculative = speculative;
+    }
+    /// Write a checkpoint to filename whenever a value of Z is computed,
+    /// and if resume is set start from the values stored in it
+    void setCheckpoint(const std::string& filename, const bool resume)
+    {
+        _checkpointFilename = filename;
+        _resume = resume;
+    }
+    /// Reuse and store the solution of every value of Z in the cache directory
+    void setCache(const std::string& directory)
+    {
+        _cacheDirectory = directory;
+    }
+    /// Write the iterations of every seed to a trace file of its own in directory
+    void setTraceDirectory(const std::string& directory)
+    {
+        _traceDirectory = directory;
+    }
+    /// Run the seeds on pool instead of on a pool of its own
+    void setThreadPool(const std::shared_ptr<ThreadPool>& pool)
+    {
+        _pool = pool;
+    }
+    /// Add symmetry-breaking constraints to every C-step model
+    void setSymmetryBreaking(const bool symmetryBreaking)
+    {
+        _symmetryBreaking = symmetryBreaking;
+    }
+    /// Keep the arc-conditional rows of every C-step model in the lazy constraint pool
+    void setLazyConstraints(const bool lazyConstraints)
+    {
+        _lazyConstraints = lazyConstraints;
+    }
+    /// Solve every C-step by enumerating all tree topologies, for small k
+    void setEnumerateTopologies(const bool enumerateTopologies)
+    {
+        _enumerateTopologies = enumerateTopologies;
+    }
+    /// Harvest up to poolSize distinct solutions from the first C-step of
+    /// every seed, the best of them replace the last random seeds of the
+    /// following values of Z
+    void setPoolSize(const int poolSize)
+    {
+        _poolSize = poolSize;
+    }
+    /// Stop a seed as soon as its distance after an M-step exceeds ratio
+    /// times the best distance of the seeds of the same Z, disabled if not positive
+    void setTerminationRatio(const double ratio)
+    {
+        _terminationRatio = ratio;
+    }
+    /// Add the C-step hot start of the best seed of the same Z to the
+    /// C-steps of the other seeds
+    void setInjectHotStarts(const bool injectHotStarts)
+    {
+        _injectHotStarts = injectHotStarts;
+    }
+    /// Launch the seeds of each value of Z incrementally and stop launching
+    /// them once patience consecutive completed seeds did not improve the
+    /// best distance, or once confirmations completed seeds reached it; the
+    /// number of seeds is then an upper bound. Criteria that are not
+    /// positive are disabled, as is the whole mode if both are.
+    void setAdaptiveSeeds(const int patience, const int confirmations)
+    {
+        _patience = patience;
+        _confirmations = confirmations;
+    }
+    /// Start the first seed from M instead of from a random usage matrix,
+    /// missing leaves are added with zero usage
+    void setSeedM(const DoubleMatrix& M)
+    {
+        _seedM = M;
+    }
     /// Get best solution
     FMCSolution getSolution() const
     {
@@ -64,6 +146,16 @@ public:
     {
         return _bestZ;
     }
+    /// Get the number of seeds launched for Z, 0 if Z was restored or not computed
+    int getNrLaunchedSeeds(const int Z) const
+    {
+        return _nrLaunchedSeeds[Z];
+    }
+    /// Get the number of seeds of Z that started from a harvested candidate
+    int getNrHarvestedSeeds(const int Z) const
+    {
+        return _nrHarvestedSeeds[Z];
+    }
     
 private:
     /// Input instance
@@ -94,28 +186,32 @@ private:
     const int _nrWorkers;
     /// Number of LPthreads
     const int _nrILPthreads;
-    /// All initial seeds
-    std::vector<DoubleMatrix> _allM0;
+    /// Base of the random streams of the seeds, drawn once from g_rng
+    const unsigned int _baseSeed;
     /// Time limit (seconds)
     const int _timeLimit;
     /// Memory limit (MB)
     const int _memoryLimit;
     /// Epsilon, the threshold estabilishing the tolerance on the objective value
     const double _eps;
-    /// Semaphore
-    boost::interprocess::interprocess_semaphore _sem;
-    /// Thread group
-    boost::thread_group _threadGroup;
     /// Mutex
     boost::mutex _mutex;
+    /// Signalled whenever a seed completes
+    boost::condition_variable _seedCompleted;
+    /// Number of seeds still running for each Z
+    IntArray _nrPendingSeeds;
+    /// Seeds that have not started yet return immediately
+    bool _discardPending;
     /// Best objective value
     DoubleArray _bestObjValue;
     /// Best copy-number tree
     std::vector<CopyNumberTree> _bestT;
     /// Best C
-    Int4Array _bestC;
+    std::vector<IntRaggedArray> _bestC;
     /// Best M
     Double3Array _bestM;
+    /// Seed of the best solution, -1 if none or inherited from a smaller Z
+    IntArray _bestSeed;
     /// Best number of events that has been found
     int _bestZ;
     /// Complete HotStarts from first iteration of each seed
@@ -124,6 +220,8 @@ private:
     std::vector<HotStart> _lastCompleteHotStart;
     /// Flags tracking whether the realtive value has already been computed
     std::vector<bool> _isComputed;
+    /// Flags tracking whether the seeds of the relative value have been submitted
+    std::vector<bool> _isLaunched;
     /// Total number of values in F, used to normaize the objective value
     double _norm;
     /// Standard HotStart that can be always used
@@ -132,15 +230,84 @@ private:
     CopyNumberTree _refinedTree;
     /// Objective value after refinement
     double _refinedObjValue;
+    /// Persistent pool of _nrWorkers threads running the seeds, possibly shared with other managers
+    std::shared_ptr<ThreadPool> _pool;
+    /// Speculatively evaluate the midpoints the binary search may need next
+    bool _speculative;
+    /// Checkpoint filename, empty if disabled
+    std::string _checkpointFilename;
+    /// Resume from the checkpoint
+    bool _resume;
+    /// Flags tracking whether the relative value has been read from the checkpoint or the cache
+    std::vector<bool> _isRestored;
+    /// Cache directory, empty if disabled
+    std::string _cacheDirectory;
+    /// Cache of the distances of previous runs
+    ResultCache _cache;
+    /// Directory of the iteration traces of the seeds, empty if disabled
+    std::string _traceDirectory;
+    /// Starting usage matrix of the first seed, empty if random
+    DoubleMatrix _seedM;
+    /// Add symmetry-breaking constraints to every C-step model
+    bool _symmetryBreaking;
+    /// Keep the arc-conditional rows of every C-step model in the lazy constraint pool
+    bool _lazyConstraints;
+    /// Solve every C-step by enumerating all tree topologies
+    bool _enumerateTopologies;
+    /// Number of pool solutions harvested from the first C-step of every seed
+    int _poolSize;
+    /// Candidates harvested by each seed for each Z
+    std::vector<std::vector<std::vector<Worker::Candidate> > > _candidates;
+    /// Ratio to the incumbent above which a seed stops, disabled if not positive
+    double _terminationRatio;
+    /// Add the hot start of the incumbent to the C-steps of the other seeds
+    bool _injectHotStarts;
+    /// Incumbent shared by the running seeds of each Z
+    std::vector<IncumbentBoard> _boards;
+    /// Consecutive non-improving seeds after which no more seeds are launched, disabled if not positive
+    int _patience;
+    /// Seeds reaching the best distance after which no more seeds are launched, disabled if not positive
+    int _confirmations;
+    /// Seeds of each Z that have not been launched yet, in order of launch
+    std::vector<std::deque<ThreadPool::Task> > _waitingSeeds;
+    /// Number of consecutive completed seeds of each Z that did not improve the best distance
+    IntArray _nrNonImproving;
+    /// Number of completed seeds of each Z that reached the best distance
+    IntArray _nrConfirmed;
+    /// Number of seeds of each Z that have been launched
+    IntArray _nrLaunchedSeeds;
+    /// Number of seeds of each Z that start from a harvested candidate
+    IntArray _nrHarvestedSeeds;
     
-    void runInstance(const int Z, const int seedIdx, const HotStart &inputCompleteHotStart);
+    DoubleMatrix buildSeed(const int seedIdx) const;
+    void runInstance(const int Z, const int seedIdx, const DoubleMatrix& M0, const HotStart &inputCompleteHotStart);
+    void submitSeeds(const int Z, const HotStart* inputCompleteHotStart);
+    std::vector<Worker::Candidate> harvestedCandidates(const int Z) const;
+    void solveInstance(Worker& worker, const int Z, const int seedIdx);
+    void shareIncumbent(Worker& worker, const int Z);
+    void launchWaitingSeed(const int Z, const double objValue);
+    void runChain(const int LZ, const int UZ, const int seedIdx, const HotStart &inputCompleteHotStart);
     void computeDistance(const int Z);
     void computeDistance(const int Z, const HotStart &inputCompleteHotStart);
+    void ensureDistance(const int Z);
+    void launchDistance(const int Z);
+    void finishDistance(const int Z);
+    void waitSeeds(const int Z);
+    void speculate(const int lb, const int ub);
+    void collectCompleted();
+    void discardPending();
     const HotStart& previousCompleteHotStart(const int Z, const int seedIdx);
     inline bool isImproving(const double previous, const double successive) const;
     void initialize();
     void initializeZwithPrevious(const int Z);
     void refinement();
+    void saveCheckpoint();
+    void loadCheckpoint();
+    std::string cacheKey() const;
+    ResultCache::Entry getEntry(const int Z) const;
+    void restoreEntry(const int Z, const ResultCache::Entry& entry);
+    bool lookupCache(const int Z);
+    void storeCache(const int Z);
 };
 
 #endif // _MANAGER_H_
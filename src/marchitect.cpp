@@ -2,7 +2,7 @@
 #include <lemon/time_measure.h>
 
 MArchitect::MArchitect(const InputInstance& inputInstance,
-                       const Int3Array& C,
+                       const IntRaggedArray& C,
                        const unsigned int k,
                        const IntMatrix &e)
     : _inputInstance(inputInstance)
@@ -13,11 +13,13 @@ MArchitect::MArchitect(const InputInstance& inputInstance,
     ,  _numChr(inputInstance.numChr())
     ,  _m(inputInstance.m())
     ,  _n(inputInstance.n())
-    , _env()
+    , _env(EnvFactory::create())
     , _model(_env)
     , _cplex(_model)
     , _x()
     , _bar_f()
+    , _fitLower()
+    , _fitUpper()
     , _obj()
     , _timer(0.0)
 {
@@ -57,6 +59,8 @@ bool MArchitect::solve(const int timeLimit, const int memoryLimit)
     }
     
     _cplex.setParam(IloCplex::Threads, 1);
+    // re-solves after updateC start from the previous basis
+    _cplex.setParam(IloCplex::AdvInd, 1);
 
     lemon::Timer timer;
     bool res = _cplex.solve();
@@ -84,6 +88,26 @@ bool MArchitect::solve(const int timeLimit, const int memoryLimit)
     return res;
 }
 
+void MArchitect::updateC(const IntRaggedArray& C)
+{
+    _C = C;
+
+    for(unsigned int chr = 0; chr < _numChr; ++chr)
+    {
+        for(unsigned int p = 0; p < _m; ++p)
+        {
+            for(unsigned int s = 0; s < _n[chr]; ++s)
+            {
+                for(unsigned int i = 0; i < _k; ++i)
+                {
+                    _fitLower[chr][p][s].setLinearCoef(_x[p][i], _C[chr][i][s]);
+                    _fitUpper[chr][p][s].setLinearCoef(_x[p][i], -_C[chr][i][s]);
+                }
+            }
+        }
+    }
+}
+
 DoubleMatrix MArchitect::getM()
 {
     DoubleMatrix result(_m);
@@ -127,10 +151,16 @@ void MArchitect::buildVariables()
 
 void MArchitect::buildConstraints()
 {
+    _fitLower = IloRange3Array(_env, _numChr);
+    _fitUpper = IloRange3Array(_env, _numChr);
     for(unsigned int chr = 0; chr < _numChr; ++chr)
     {
+        _fitLower[chr] = IloRangeMatrix(_env, _m);
+        _fitUpper[chr] = IloRangeMatrix(_env, _m);
         for(unsigned int p = 0; p < _m; ++p)
         {
+            _fitLower[chr][p] = IloRangeArray(_env, _n[chr]);
+            _fitUpper[chr][p] = IloRangeArray(_env, _n[chr]);
             for(unsigned int s = 0; s < _n[chr]; ++s)
             {
                 IloExpr sum_u_y(_env);
@@ -140,8 +170,11 @@ void MArchitect::buildConstraints()
                     sum_u_y += _x[p][i] * _C[chr][i][s];
                 }
 
-                _model.add(_bar_f[chr][p][s] - _F[chr][p][s] + sum_u_y >= 0);
-                _model.add(_bar_f[chr][p][s] + _F[chr][p][s] - sum_u_y >= 0);
+                _fitLower[chr][p][s] = IloRange(_env, _F[chr][p][s], _bar_f[chr][p][s] + sum_u_y, IloInfinity);
+                _fitUpper[chr][p][s] = IloRange(_env, -_F[chr][p][s], _bar_f[chr][p][s] - sum_u_y, IloInfinity);
+                _model.add(_fitLower[chr][p][s]);
+                _model.add(_fitUpper[chr][p][s]);
+                sum_u_y.end();
             }
         }
     }
@@ -167,7 +200,7 @@ void MArchitect::buildObjective()
         {
             for(unsigned int s = 0; s < _n[chr]; ++s)
             {
-                _obj += _bar_f[chr][p][s];
+                _obj += _inputInstance.w()[chr][s] * _bar_f[chr][p][s];
             }
         }
     }
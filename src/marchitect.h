@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <cmath>
 #include <ilcplex/ilocplex.h>
+#include "envfactory.h"
 
 #include "inputinstance.h"
 #include "basic_types.h"
@@ -21,7 +22,7 @@ class MArchitect
 {
 public:
     MArchitect(const InputInstance& inputInstance,
-               const Int3Array& C,
+               const IntRaggedArray& C,
                const unsigned int k,
                const IntMatrix &e);
 
@@ -35,6 +36,9 @@ public:
     void init();
     bool solve(const int timeLimit, const int memoryLimit);
 
+    /// Replace the copy numbers by updating the coefficients of the fit constraints in place
+    void updateC(const IntRaggedArray& C);
+
     DoubleMatrix getM();
 
     double getObjValue()
@@ -70,6 +74,9 @@ protected:
     typedef IloArray<IloNumVar3Array> IloNumVar4Array;
     typedef IloArray<IloNumVar4Array> IloNumVar5Array;
 
+    typedef IloArray<IloRangeArray> IloRangeMatrix;
+    typedef IloArray<IloRangeMatrix> IloRange3Array;
+
     typedef IloArray<IloIntVarArray> IloIntVarMatrix;
     typedef IloArray<IloIntVarMatrix> IloIntVar3Array;
     typedef IloArray<IloIntVar3Array> IloIntVar4Array;
@@ -79,13 +86,13 @@ protected:
     /// Input instance
     const InputInstance& _inputInstance;
     /// Copy number matrix, just the leaves
-    const Int3Array& _C;
+    IntRaggedArray _C;
     /// Number of leaves
     const unsigned int _k;
     /// Maximum copy number per chromosome, per position
     const IntMatrix& _e;
     /// Input frequencies from _inputInstance
-    const Double3Array& _F;
+    const DoubleRaggedArray& _F;
     /// Number of chromosomes
     const unsigned int _numChr;
     /// Number of samples
@@ -102,6 +109,10 @@ protected:
     IloNumVarMatrix _x;
     /// TODO
     IloNumVar3Array _bar_f;
+    /// Fit constraints bar_f - F + sum_u_y >= 0 per chromosome, sample, position
+    IloRange3Array _fitLower;
+    /// Fit constraints bar_f + F - sum_u_y >= 0 per chromosome, sample, position
+    IloRange3Array _fitUpper;
     /// TODO
     IloExpr _obj;
     /// TODO
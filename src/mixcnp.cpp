@@ -4,6 +4,8 @@
 #include <cstdlib>
 #include <algorithm>
 #include <stdexcept>
+#include <memory>
+#include <string>
 #include <lemon/arg_parser.h>
 
 #include <boost/random.hpp>
@@ -15,6 +17,7 @@
 
 #include "basic_types.h"
 #include "manager.h"
+#include "threadpool.h"
 
 int main(int argc, char** argv)
 {
@@ -23,17 +26,33 @@ int main(int argc, char** argv)
     int memoryLimit = -1;
     const int size_bubbles = 10;
     std::string outputFilename;
+    std::string checkpointFilename;
+    std::string cacheDirectory;
+    std::string traceDirectory;
 
     int maxCopyNumber = -1;
     int maxSizeTree = -1;
     int lbMaxSizeTree = 0;
     int k = 4;
+    int ubK = -1;
     double eps = 0.0;
+    double compressTol = -1.0;
+    double diploidTol = -1.0;
     bool forceDiploid = false;
     bool rootNotFixed = false;
     bool deactiveRefinement = false;
+    bool speculative = false;
+    bool resume = false;
+    bool symmetryBreaking = false;
+    bool enumerateTopologies = false;
+    bool lazyConstraints = false;
 
     int numStarts = 10;
+    int poolSize = 0;
+    int patience = -1;
+    int confirmations = -1;
+    double terminationRatio = -1.0;
+    bool injectHotStarts = false;
     int numIterConvergence = 2;
     int maxIter = 7;
     int numILPThreads = 1;
@@ -48,20 +67,36 @@ int main(int argc, char** argv)
       .refOption("Z", "Maximum size of tree for all chromosomes", maxSizeTree, true)
       .refOption("lbZ", "Lower bound for maximum size of tree for all chromosomes (default: 0)", lbMaxSizeTree)
       .refOption("k", "Number of leaves", k, true)
+      .refOption("uk", "Upper bound on the number of leaves, every number of leaves in [k, uk] is run in turn (default: -1, disabled)", ubK)
       .refOption("t", "Epsilon, threshold level of tolerance for normalized distance (default: 0.0)", eps)
       .refOption("r", "Mode for searching parsimonious number of events: (1) Binary Search (2) Reverse Iterative (3) Full Iterative (default: 1)", mode)
       .refOption("s", "Time limit in seconds for each C-step (default: -1, disabled)", timeLimit)
-      .refOption("ns", "Number of starting seeds (default: 10)", numStarts)
+      .refOption("ns", "Number of starting seeds, an upper bound with -sa or -sc (default: 10)", numStarts)
+      .refOption("sa", "Stop launching seeds for a value of Z once this many consecutive completed seeds did not improve its distance (default: -1, disabled)", patience)
+      .refOption("sc", "Stop launching seeds for a value of Z once this many completed seeds reached its distance (default: -1, disabled)", confirmations)
+      .refOption("sp", "Number of distinct solutions harvested from the solution pool of the first C-step of each seed, the best replace the last random seeds of the next values of Z (default: 0)", poolSize)
       .refOption("ni", "Number of iterations per seed (default: 7)", maxIter)
       .refOption("j", "Number of workers (default: 2)", numWorkers)
       .refOption("nt", "Number of ILP threads (default: 1)", numILPThreads)
+      .refOption("pd", "Remove the segments whose fractional copy numbers equal 2 up to this tolerance in every sample (default: -1, disabled)", diploidTol)
+      .refOption("pc", "Merge adjacent segments whose fractional copy numbers differ by at most this value in every sample (default: -1, disabled)", compressTol)
       .refOption("m", "Memory limit in MB for each worker (default: -1, disabled)", memoryLimit)
       .refOption("e", "Maximum copy number (default: -1, inferred from leaves)", maxCopyNumber)
       .refOption("d", "Force one clone to be the normal diploid (default: false)", forceDiploid)
       .refOption("f", "Do not fix root to all 2s", rootNotFixed)
+      .refOption("ic", "Stop a seed once its distance after an M-step exceeds this ratio times the best distance of the seeds of the same Z (default: -1, disabled)", terminationRatio)
+      .refOption("ih", "Add the C-step hot start of the best seed of the same Z to the C-steps of the other running seeds (default: false)", injectHotStarts)
+      .refOption("sy", "Add symmetry-breaking constraints on the numbering of the internal vertices to the C-step (default: false)", symmetryBreaking)
+      .refOption("lc", "Add the rows of the C-step that only bind on selected arcs as lazy constraints (default: false)", lazyConstraints)
+      .refOption("et", "Solve every C-step by enumerating all tree topologies and decomposing by chromosome, for small k (default: false)", enumerateTopologies)
+      .refOption("tr", "Trace directory where every seed writes the tree, proportions and distances of each iteration (default: disabled)", traceDirectory)
       .refOption("ss", "Random number seed (default: 0)", seed)
       .refOption("v", "Verbosity level from 0 to 4 (default: 1)", verbosityLevel)
       .refOption("dr", "Deactivate refinement", deactiveRefinement)
+      .refOption("cd", "Cache directory where the distances of each value of Z are reused across runs (default: disabled)", cacheDirectory)
+      .refOption("cp", "Checkpoint filename, rewritten whenever the distance of a value of Z is computed (default: disabled)", checkpointFilename)
+      .refOption("rs", "Resume from the checkpoint given by -cp, skipping the values of Z it contains (default: false)", resume)
+      .refOption("sb", "Speculatively evaluate the next midpoints of the binary search on idle workers (default: false)", speculative)
       .other("input", "Input file");
     ap.parse();
     g_rng = std::mt19937(seed);
@@ -73,6 +108,32 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (resume && checkpointFilename.empty())
+    {
+        std::cerr << "ERROR: -rs requires a checkpoint file given by -cp" << std::endl;
+        return 1;
+    }
+
+    // below 1 the seed holding the incumbent would stop itself
+    if (terminationRatio > 0 && terminationRatio < 1)
+    {
+        std::cerr << "ERROR: -ic must be at least 1, or not positive to disable the cutoff" << std::endl;
+        return 1;
+    }
+
+    // the enumerated topologies have neither a solution pool nor hot starts
+    if (enumerateTopologies && poolSize > 0)
+    {
+        std::cerr << "ERROR: -sp requires the full C-step model (no -et)" << std::endl;
+        return 1;
+    }
+
+    if (enumerateTopologies && injectHotStarts)
+    {
+        std::cerr << "ERROR: -ih requires the full C-step model (no -et)" << std::endl;
+        return 1;
+    }
+
     InputInstance inputInstance;
     std::ifstream inFile(ap.files()[0].c_str());
 
@@ -89,48 +150,145 @@ int main(int argc, char** argv)
         maxCopyNumber = inputInstance.e();
         std::cerr << "e:  " << maxCopyNumber << endl;
     }
-    IntMatrix e(inputInstance.numChr());
-    for(unsigned int chr = 0; chr < inputInstance.numChr(); ++chr)
+
+    if (diploidTol >= 0 && rootNotFixed)
     {
-        e[chr] = IntArray(inputInstance.n()[chr], maxCopyNumber);
+        std::cerr << "ERROR: -pd requires the root to be fixed to the normal diploid (no -f)" << std::endl;
+        return 1;
     }
-    
-    Manager manager(inputInstance, k, e, lbMaxSizeTree, maxSizeTree,
-                    forceDiploid, rootNotFixed, deactiveRefinement,
-                    size_bubbles, numIterConvergence,
-                    maxIter, numStarts, numWorkers, numILPThreads,
-                    timeLimit, memoryLimit, eps);
-    switch(mode)
+
+    // The search runs on the presolved instance, solutions are expanded back
+    // to the segmentation of the input when they are written. Diploid
+    // segments are removed first, such that merging never crosses them.
+    const InputInstance reducedInstance = diploidTol >= 0 ? inputInstance.removeDiploid(diploidTol) : inputInstance;
+    const InputInstance presolvedInstance = compressTol >= 0 ? reducedInstance.compress(compressTol) : reducedInstance;
+    if ((diploidTol >= 0 || compressTol >= 0) && g_verbosity >= VERBOSE_ESSENTIAL)
     {
-        case(1): manager.runBinarySearch(); break;
-        case(2): manager.runReverse()   ; break;
-        case(3): manager.runIterative(); break;
+        std::cerr << timestamp() << "Presolve reduced " << inputInstance.numSegments() << " segments on "
+                  << inputInstance.numChr() << " chromosomes to " << sum_of_elements(presolvedInstance.n())
+                  << " segments on " << presolvedInstance.numChr() << " chromosomes, removed diploid segments contribute "
+                  << presolvedInstance.diploidDistance() << " to the distance" << std::endl;
     }
 
-    if (g_verbosity >= VERBOSE_ESSENTIAL)
+    IntMatrix e(presolvedInstance.numChr());
+    for(unsigned int chr = 0; chr < presolvedInstance.numChr(); ++chr)
+    {
+        e[chr] = IntArray(presolvedInstance.n()[chr], maxCopyNumber);
+    }
+    
+    // Sweep over the number of leaves, every value writes its solution to a
+    // file of its own and starts its first seed from the best M of the previous one
+    const int lbK = k;
+    ubK = std::max(ubK, lbK);
+    const bool sweep = ubK > lbK;
+    if (sweep && outputFilename.empty())
     {
-        std::cerr << std::endl;
-        std::cerr << "SOLUTION FOUND: " << manager.getObjValue() << std::endl;
-        std::cerr << std::endl;
+        std::cerr << "ERROR: -uk requires an output filename given by -o" << std::endl;
+        return 1;
     }
 
-    if(outputFilename.empty())
+    std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>(numWorkers);
+    DoubleMatrix seedM;
+    std::stringstream summary;
+    summary << "k\tZ\tdistance\tevents" << std::endl;
+
+    for (k = lbK; k <= ubK; ++k)
     {
-        std::cout << manager.getSolution();
+        Manager manager(presolvedInstance, k, e, lbMaxSizeTree, maxSizeTree,
+                        forceDiploid, rootNotFixed, deactiveRefinement,
+                        size_bubbles, numIterConvergence,
+                        maxIter, numStarts, numWorkers, numILPThreads,
+                        timeLimit, memoryLimit, eps);
+        manager.setSpeculative(speculative);
+        manager.setSymmetryBreaking(symmetryBreaking);
+        manager.setEnumerateTopologies(enumerateTopologies);
+        manager.setLazyConstraints(lazyConstraints);
+        manager.setPoolSize(poolSize);
+        manager.setAdaptiveSeeds(patience, confirmations);
+        manager.setTerminationRatio(terminationRatio);
+        manager.setInjectHotStarts(injectHotStarts);
+        manager.setThreadPool(pool);
+        manager.setSeedM(seedM);
+        manager.setCache(cacheDirectory);
+        manager.setTraceDirectory(traceDirectory);
+        if (sweep && !checkpointFilename.empty())
+        {
+            manager.setCheckpoint(checkpointFilename + ".k" + std::to_string(k), resume);
+        }
+        else
+        {
+            manager.setCheckpoint(checkpointFilename, resume);
+        }
+
+        if (sweep && g_verbosity >= VERBOSE_ESSENTIAL)
+        {
+            std::cerr << timestamp() << "Number of leaves k=" << k << std::endl;
+        }
+
+        switch(mode)
+        {
+            case(1): manager.runBinarySearch(); break;
+            case(2): manager.runReverse()   ; break;
+            case(3): manager.runIterative(); break;
+        }
+
+        const FMCSolution solution(manager.getSolution().getTree().expand(presolvedInstance.w())
+                                                                  .insertDiploid(inputInstance.n(), presolvedInstance.origin()),
+                                   manager.getSolution().getM(), inputInstance);
+        // merged segments are fitted by their mean, so the distance is measured
+        // again on the input instead of being taken from the presolved search
+        const double objValue = solution.getObjValue();
+        if (g_verbosity >= VERBOSE_ESSENTIAL)
+        {
+            std::cerr << std::endl;
+            std::cerr << "SOLUTION FOUND: " << objValue << std::endl;
+            std::cerr << std::endl;
+        }
+
+        seedM = solution.getM();
+        summary << k << "\t" << manager.getSlopePoint() << "\t" << objValue
+                << "\t" << solution.getTree().cost() << std::endl;
+
+        if(outputFilename.empty())
+        {
+            std::cout << solution;
+        }
+        else
+        {
+            const std::string filename = sweep ? outputFilename + ".k" + std::to_string(k) : outputFilename;
+            std::ofstream ofs(filename.c_str());
+            if (ofs.good())
+            {
+                ofs << solution;
+                ofs.close();
+            }
+            else
+            {
+                std::cerr << "Error: could not open '" << filename << "' for writing" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
     }
-    else
+
+    if (sweep)
     {
-        std::ofstream ofs(outputFilename.c_str());
+        const std::string filename = outputFilename + ".summary";
+        std::ofstream ofs(filename.c_str());
         if (ofs.good())
         {
-            ofs << manager.getSolution();
+            ofs << summary.str();
             ofs.close();
         }
         else
         {
-            std::cerr << "Error: could not open '" << outputFilename << "' for writing" << std::endl;
+            std::cerr << "Error: could not open '" << filename << "' for writing" << std::endl;
             return EXIT_FAILURE;
         }
+
+        if (g_verbosity >= VERBOSE_ESSENTIAL)
+        {
+            std::cerr << summary.str();
+        }
     }
 
     return 0;
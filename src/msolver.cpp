@@ -0,0 +1,495 @@
+#include "msolver.h"
+#include <lemon/time_measure.h>
+#include <boost/bind.hpp>
+
+MSolver::MSolver(const InputInstance& inputInstance,
+                 const IntRaggedArray& C,
+                 const unsigned int k)
+    : _inputInstance(inputInstance)
+    , _C()
+    , _k(k)
+    , _F(inputInstance.F())
+    , _numChr(inputInstance.numChr())
+    , _m(inputInstance.m())
+    , _n(inputInstance.n())
+    , _N(sum_of_elements(inputInstance.n()))
+    , _A()
+    , _f(_m, DoubleArray(_N, 0.0))
+    , _M(_m, DoubleArray(_k, 1.0 / _k))
+    , _basis(_m)
+    , _sampleObjValue(_m, 0.0)
+    , _sampleSolved(_m, 0)
+    , _objValue(0.0)
+    , _timer(0.0)
+{
+    for(unsigned int p = 0; p < _m; ++p)
+    {
+        unsigned int r = 0;
+        for(unsigned int chr = 0; chr < _numChr; ++chr)
+        {
+            for(unsigned int s = 0; s < _n[chr]; ++s, ++r)
+            {
+                _f[p][r] = _inputInstance.w()[chr][s] * _F[chr][p][s];
+            }
+        }
+    }
+
+    updateC(C);
+}
+
+void MSolver::updateC(const IntRaggedArray& C)
+{
+    _C = C;
+
+    _A = DoubleMatrix(_N, DoubleArray(_k, 0.0));
+    unsigned int r = 0;
+    for(unsigned int chr = 0; chr < _numChr; ++chr)
+    {
+        for(unsigned int s = 0; s < _n[chr]; ++s, ++r)
+        {
+            for(unsigned int i = 0; i < _k; ++i)
+            {
+                _A[r][i] = _inputInstance.w()[chr][s] * _C[chr][i][s];
+            }
+        }
+    }
+}
+
+bool MSolver::solve(const int nrThreads)
+{
+    if (g_verbosity >= VERBOSE_DEBUG)
+    {
+        std::cerr << ">> Start native M-step" << std::endl;
+    }
+
+    lemon::Timer timer;
+
+    const unsigned int nrSolvers = std::max(1, std::min(nrThreads, (int)_m));
+    if (nrSolvers == 1)
+    {
+        solveSamples(0, 1);
+    }
+    else
+    {
+        boost::thread_group threads;
+        for(unsigned int t = 0; t < nrSolvers; ++t)
+        {
+            threads.create_thread(boost::bind(&MSolver::solveSamples, this, t, nrSolvers));
+        }
+        threads.join_all();
+    }
+
+    _timer = timer.realTime();
+
+    bool res = true;
+    _objValue = 0.0;
+    for(unsigned int p = 0; p < _m; ++p)
+    {
+        res &= (_sampleSolved[p] == 1);
+        _objValue += _sampleObjValue[p];
+    }
+
+    if (g_verbosity >= VERBOSE_DEBUG)
+    {
+        std::cerr << "Solution value = " << _objValue << std::endl;
+        std::cerr << "Runtime = " << _timer << " seconds" << std::endl;
+        std::cerr << ">> End native M-step" << std::endl;
+    }
+
+    return res;
+}
+
+void MSolver::solveSamples(const unsigned int p, const unsigned int stride)
+{
+    for(unsigned int q = p; q < _m; q += stride)
+    {
+        _sampleSolved[q] = solveSample(q) ? 1 : 0;
+    }
+}
+
+/**
+ The M-step of sample p is
+
+    min \sum_r |f_r - A_r x|  s.t.  \sum_i x_i = 1, x >= 0
+
+ whose dual only has one row per leaf i, here written as a minimization
+
+    min -\sum_r f_r w_r - lambda  s.t.  \sum_r A_{r,i} w_r + lambda + s_i = 0,
+                                        -1 <= w_r <= 1, s_i >= 0, lambda free
+
+ A basis of this LP is dual feasible as soon as the simplex multipliers -pi
+ are a point x of the unit simplex, with every nonbasic w_r at the sign of
+ its residual f_r - A_r x. We run the dual simplex from such a basis: each
+ iteration moves x and the bound flipping ratio test passes over all the
+ residuals that change sign along the way, such that the number of pivots
+ is small even for genome-wide inputs. At optimality x = -pi.
+ **/
+bool MSolver::solveSample(const unsigned int p)
+{
+    const double tolPrimal = 1e-9;
+    const double tolDual = 1e-9;
+    const double tolPivot = 1e-9;
+
+    const DoubleArray& f = _f[p];
+
+    // variables: w_r for 0 <= r < N, lambda = N, s_i = N + 1 + i
+    const int lambda = _N;
+    const int nrVars = _N + 1 + _k;
+
+    IntArray& basis = _basis[p];
+    IntArray position(nrVars, -1);
+    DoubleArray value(nrVars, 0.0);
+    DoubleArray d(nrVars, 0.0);
+
+    bool warm = basis.size() == _k;
+    if(warm)
+    {
+        for(unsigned int i = 0; i < _k; ++i)
+        {
+            position[basis[i]] = i;
+        }
+    }
+
+    // degenerate pivots may cycle under the largest violation rule, Bland's rule does not
+    const unsigned int maxIter = 50 * (_N + _k);
+    const unsigned int blandIter = _N + _k;
+    DoubleMatrix Binv(_k, DoubleArray(_k, 0.0));
+    DoubleArray pi(_k, 0.0);
+    DoubleArray rhs(_k, 0.0);
+    std::vector<std::pair<double, int> > candidates;
+
+    bool optimal = false;
+    for(unsigned int iter = 0; iter < maxIter && !optimal; ++iter)
+    {
+        if(basis.size() != _k)
+        {
+            // cold start from the best vertex x = e_top: lambda basic in row top, slacks elsewhere
+            unsigned int top = 0;
+            double topObj = std::numeric_limits<double>::max();
+            for(unsigned int i = 0; i < _k; ++i)
+            {
+                double obj = 0.0;
+                for(unsigned int r = 0; r < _N; ++r)
+                {
+                    obj += std::fabs(f[r] - _A[r][i]);
+                }
+                if(obj < topObj)
+                {
+                    top = i;
+                    topObj = obj;
+                }
+            }
+
+            basis = IntArray(_k, -1);
+            std::fill(position.begin(), position.end(), -1);
+            for(unsigned int i = 0; i < _k; ++i)
+            {
+                basis[i] = i == top ? lambda : _N + 1 + i;
+                position[basis[i]] = i;
+            }
+            std::fill(value.begin(), value.end(), 0.0);
+            warm = false;
+        }
+
+        // basis inverse
+        for(unsigned int i = 0; i < _k; ++i)
+        {
+            const int b = basis[i];
+            for(unsigned int l = 0; l < _k; ++l)
+            {
+                if(b < lambda)
+                    Binv[l][i] = _A[b][l];
+                else if(b == lambda)
+                    Binv[l][i] = 1.0;
+                else
+                    Binv[l][i] = (b - lambda - 1 == l) ? 1.0 : 0.0;
+            }
+        }
+        if(!invert(Binv))
+        {
+            if(warm)
+            {
+                basis.clear();
+                continue;
+            }
+            return false;
+        }
+
+        // simplex multipliers
+        for(unsigned int l = 0; l < _k; ++l)
+        {
+            pi[l] = 0.0;
+            for(unsigned int i = 0; i < _k; ++i)
+            {
+                const int b = basis[i];
+                const double cost = b < lambda ? -f[b] : (b == lambda ? -1.0 : 0.0);
+                pi[l] += cost * Binv[i][l];
+            }
+        }
+
+        // reduced costs, nonbasic w are placed at the bound given by their sign
+        bool dualFeasible = true;
+        for(unsigned int r = 0; r < _N; ++r)
+        {
+            if(position[r] != -1)
+                continue;
+
+            d[r] = -f[r];
+            for(unsigned int l = 0; l < _k; ++l)
+            {
+                d[r] -= pi[l] * _A[r][l];
+            }
+            if(d[r] > tolDual)
+                value[r] = -1.0;
+            else if(d[r] < -tolDual)
+                value[r] = 1.0;
+            else if(value[r] == 0.0)
+                value[r] = -1.0;
+        }
+        for(unsigned int i = 0; i < _k; ++i)
+        {
+            const int j = _N + 1 + i;
+            if(position[j] != -1)
+                continue;
+
+            d[j] = -pi[i];
+            value[j] = 0.0;
+            dualFeasible &= d[j] >= -tolDual;
+        }
+        if(!dualFeasible)
+        {
+            if(warm)
+            {
+                basis.clear();
+                continue;
+            }
+            return false;
+        }
+
+        // basic values
+        std::fill(rhs.begin(), rhs.end(), 0.0);
+        for(unsigned int r = 0; r < _N; ++r)
+        {
+            if(position[r] == -1)
+            {
+                for(unsigned int l = 0; l < _k; ++l)
+                {
+                    rhs[l] -= _A[r][l] * value[r];
+                }
+            }
+        }
+        for(unsigned int i = 0; i < _k; ++i)
+        {
+            double v = 0.0;
+            for(unsigned int l = 0; l < _k; ++l)
+            {
+                v += Binv[i][l] * rhs[l];
+            }
+            value[basis[i]] = v;
+        }
+
+        // leaving variable: largest bound violation, or the smallest index under
+        // Bland's rule, the free lambda never leaves
+        const bool bland = iter >= blandIter;
+        int leave = -1;
+        double delta = 0.0;
+        for(unsigned int i = 0; i < _k; ++i)
+        {
+            const int b = basis[i];
+            if(b == lambda)
+                continue;
+
+            double violation = 0.0;
+            if(b < lambda && value[b] > 1.0 + tolPrimal)
+                violation = value[b] - 1.0;
+            else if(value[b] < (b < lambda ? -1.0 : 0.0) - tolPrimal)
+                violation = value[b] - (b < lambda ? -1.0 : 0.0);
+
+            if(violation == 0.0)
+                continue;
+
+            if(bland ? (leave == -1 || b < basis[leave]) : std::fabs(violation) > std::fabs(delta))
+            {
+                delta = violation;
+                leave = i;
+            }
+        }
+
+        if(leave == -1)
+        {
+            optimal = true;
+            break;
+        }
+
+        // entering candidates from the row of the leaving variable
+        candidates.clear();
+        for(int j = 0; j < nrVars; ++j)
+        {
+            if(j == lambda || position[j] != -1)
+                continue;
+
+            double alpha = 0.0;
+            if(j < lambda)
+            {
+                for(unsigned int l = 0; l < _k; ++l)
+                {
+                    alpha += Binv[leave][l] * _A[j][l];
+                }
+            }
+            else
+            {
+                alpha = Binv[leave][j - lambda - 1];
+            }
+
+            // moving x_j away from its bound must decrease the violation
+            const bool atLower = j < lambda ? value[j] < 0 : true;
+            const double direction = delta < 0 ? -alpha : alpha;
+            if((atLower && direction > tolPivot) || (!atLower && direction < -tolPivot))
+            {
+                candidates.push_back(std::make_pair(std::fabs(d[j]) / std::fabs(alpha), j));
+            }
+        }
+
+        if(candidates.empty())
+        {
+            // dual unbounded, cannot happen since the primal is feasible
+            return false;
+        }
+
+        std::sort(candidates.begin(), candidates.end());
+
+        if(bland)
+        {
+            // smallest index among the ties of the plain ratio test
+            int enter = candidates.front().second;
+            for(const std::pair<double, int>& candidate : candidates)
+            {
+                if(candidate.first > candidates.front().first + tolDual)
+                    break;
+                enter = std::min(enter, candidate.second);
+            }
+
+            const int b = basis[leave];
+            value[b] = b < lambda ? (delta > 0 ? 1.0 : -1.0) : 0.0;
+            position[b] = -1;
+            basis[leave] = enter;
+            position[enter] = leave;
+            continue;
+        }
+
+        // bound flipping ratio test: pass boxed candidates while the slope stays positive
+        double slope = std::fabs(delta);
+        int enter = candidates.back().second;
+        for(const std::pair<double, int>& candidate : candidates)
+        {
+            const int j = candidate.second;
+            if(j > lambda)
+            {
+                enter = j;
+                break;
+            }
+
+            double alpha = 0.0;
+            for(unsigned int l = 0; l < _k; ++l)
+            {
+                alpha += Binv[leave][l] * _A[j][l];
+            }
+            slope -= 2.0 * std::fabs(alpha);
+            if(slope <= 0)
+            {
+                enter = j;
+                break;
+            }
+        }
+
+        const int b = basis[leave];
+        value[b] = b < lambda ? (delta > 0 ? 1.0 : -1.0) : 0.0;
+        position[b] = -1;
+        basis[leave] = enter;
+        position[enter] = leave;
+    }
+
+    if(!optimal)
+    {
+        basis.clear();
+        return false;
+    }
+
+    // the simplex multipliers are the proportions
+    double sum = 0.0;
+    for(unsigned int i = 0; i < _k; ++i)
+    {
+        _M[p][i] = std::max(0.0, -pi[i]);
+        sum += _M[p][i];
+    }
+    if(sum <= 0)
+    {
+        basis.clear();
+        return false;
+    }
+    for(unsigned int i = 0; i < _k; ++i)
+    {
+        _M[p][i] /= sum;
+    }
+
+    double obj = 0.0;
+    for(unsigned int r = 0; r < _N; ++r)
+    {
+        double res = f[r];
+        for(unsigned int i = 0; i < _k; ++i)
+        {
+            res -= _A[r][i] * _M[p][i];
+        }
+        obj += std::fabs(res);
+    }
+    _sampleObjValue[p] = obj;
+
+    return true;
+}
+
+bool MSolver::invert(DoubleMatrix& B)
+{
+    const unsigned int k = B.size();
+    DoubleMatrix I(k, DoubleArray(k, 0.0));
+    for(unsigned int i = 0; i < k; ++i)
+    {
+        I[i][i] = 1.0;
+    }
+
+    for(unsigned int col = 0; col < k; ++col)
+    {
+        unsigned int pivot = col;
+        for(unsigned int i = col + 1; i < k; ++i)
+        {
+            if(std::fabs(B[i][col]) > std::fabs(B[pivot][col]))
+                pivot = i;
+        }
+        if(std::fabs(B[pivot][col]) < 1e-12)
+        {
+            return false;
+        }
+        std::swap(B[pivot], B[col]);
+        std::swap(I[pivot], I[col]);
+
+        const double scale = 1.0 / B[col][col];
+        for(unsigned int l = 0; l < k; ++l)
+        {
+            B[col][l] *= scale;
+            I[col][l] *= scale;
+        }
+        for(unsigned int i = 0; i < k; ++i)
+        {
+            if(i == col || B[i][col] == 0.0)
+                continue;
+            const double factor = B[i][col];
+            for(unsigned int l = 0; l < k; ++l)
+            {
+                B[i][l] -= factor * B[col][l];
+                I[i][l] -= factor * I[col][l];
+            }
+        }
+    }
+
+    B.swap(I);
+    return true;
+}
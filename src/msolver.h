@@ -0,0 +1,100 @@
+#ifndef _MSOLVER_H_
+#define _MSOLVER_H_
+
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+#include "inputinstance.h"
+#include "basic_types.h"
+
+/// This class solves the M-step without CPLEX. Given the leaf profiles C, the
+/// problem separates by sample p into an L1 regression of F[.][p][.] on the
+/// k leaf profiles under the constraint that the row of M lies in the unit
+/// simplex. Each of these problems is solved exactly by a dual simplex with
+/// bound flipping on an LP with only k rows, and samples are solved in parallel.
+class MSolver
+{
+public:
+    MSolver(const InputInstance& inputInstance,
+            const IntRaggedArray& C,
+            const unsigned int k);
+
+    /// Solve all samples using at most nrThreads threads
+    bool solve(const int nrThreads);
+
+    /// Replace the copy numbers, the previous bases are kept as hot start
+    void updateC(const IntRaggedArray& C);
+
+    DoubleMatrix getM() const
+    {
+        return _M;
+    }
+
+    double getObjValue() const
+    {
+        return _objValue;
+    }
+
+    double getUB() const
+    {
+        return _objValue;
+    }
+
+    double getLB() const
+    {
+        return _objValue;
+    }
+
+    double getTime() const
+    {
+        return _timer;
+    }
+
+private:
+    /// Solve the L1 regression of sample p, return false if it did not converge
+    bool solveSample(const unsigned int p);
+    /// Solve the samples p, p + stride, p + 2 stride, ...
+    void solveSamples(const unsigned int p, const unsigned int stride);
+    /// Invert the k x k matrix B in place, return false if it is singular
+    static bool invert(DoubleMatrix& B);
+
+private:
+    /// Input instance
+    const InputInstance& _inputInstance;
+    /// Copy number matrix, just the leaves
+    IntRaggedArray _C;
+    /// Number of leaves
+    const unsigned int _k;
+    /// Input frequencies from _inputInstance
+    const DoubleRaggedArray& _F;
+    /// Number of chromosomes
+    const unsigned int _numChr;
+    /// Number of samples
+    const unsigned int _m;
+    /// Number of positions of each chromosome
+    const IntArray& _n;
+    /// Total number of positions over all chromosomes
+    const unsigned int _N;
+    /// Leaf copy numbers per position over all chromosomes, scaled by the segment weights: N x k
+    DoubleMatrix _A;
+    /// Fractional copy numbers per sample over all chromosomes, scaled by the segment weights: m x N
+    DoubleMatrix _f;
+    /// Usage matrix
+    DoubleMatrix _M;
+    /// Optimal basis per sample of the previous solve
+    IntMatrix _basis;
+    /// Objective value per sample
+    DoubleArray _sampleObjValue;
+    /// Convergence per sample (1 if solved)
+    IntArray _sampleSolved;
+    /// Objective value
+    double _objValue;
+    /// Running time of the last solve (seconds)
+    double _timer;
+};
+
+#endif // _MSOLVER_H_
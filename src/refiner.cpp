@@ -24,7 +24,7 @@ double Refiner::getDistance()
         {
             for(unsigned int s = 0; s < _n[chr]; ++s)
             {
-                result += _cplex.getValue(_bar_f[chr][p][s]);
+                result += _inputInstance.w()[chr][s] * _cplex.getValue(_bar_f[chr][p][s]);
             }
         }
     }
@@ -43,7 +43,7 @@ void Refiner::buildConstraints()
         {
             for(unsigned int s = 0; s < _n[chr]; ++s)
             {
-                sum_bar_f += _bar_f[chr][p][s];
+                sum_bar_f += _inputInstance.w()[chr][s] * _bar_f[chr][p][s];
             }
         }
     }
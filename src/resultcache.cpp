@@ -0,0 +1,260 @@
+#include "resultcache.h"
+
+#include <fstream>
+#include <cstdio>
+#include <iomanip>
+#include <cstdint>
+
+ResultCache::ResultCache()
+    : _directory()
+    , _hash()
+{
+}
+
+
+ResultCache::ResultCache(const std::string& directory, const std::string& key)
+    : _directory(directory)
+    , _hash(hash(key))
+{
+}
+
+
+bool ResultCache::lookup(const int Z, Entry& entry) const
+{
+    if(!enabled())
+        return false;
+
+    std::ifstream in(filename(Z).c_str());
+    if(!in.good())
+        return false;
+
+    std::string line;
+    std::getline(in, line);
+    if(line != "#CACHE " + _hash)
+        return false;
+
+    try {
+        read(in, entry);
+    } catch (const std::runtime_error& ex) {
+        // an unreadable entry is a miss, it will be overwritten
+        if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+            std::cerr << timestamp() << "Ignoring cache entry " << filename(Z) << ": " << ex.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+void ResultCache::store(const int Z, const Entry& entry) const
+{
+    if(!enabled())
+        return;
+
+    // Concurrent runs may share the directory, so the entry is written to a
+    // file of its own and then renamed in place
+    std::stringstream tmpFilename;
+    tmpFilename << filename(Z) << ".tmp" << boost::this_thread::get_id();
+
+    std::ofstream out(tmpFilename.str().c_str());
+    if(!out.good())
+    {
+        if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+            std::cerr << timestamp() << "WARNING: cannot write to cache directory " << _directory << std::endl;
+        return;
+    }
+
+    out << "#CACHE " << _hash << std::endl;
+    write(out, entry);
+    out.close();
+
+    if(std::rename(tmpFilename.str().c_str(), filename(Z).c_str()) != 0)
+    {
+        std::remove(tmpFilename.str().c_str());
+        if(g_verbosity >= VerbosityLevel::VERBOSE_ESSENTIAL)
+            std::cerr << timestamp() << "WARNING: cannot write cache entry " << filename(Z) << std::endl;
+    }
+}
+
+
+void ResultCache::write(std::ostream& out, const Entry& entry)
+{
+    const std::streamsize precision = out.precision(std::numeric_limits<double>::max_digits10);
+
+    out << entry._objValue << " " << entry._bestSeed << std::endl;
+
+    out << "#FIRST " << entry._firstCompleteHotStart.size() << std::endl;
+    for (const HotStart& hotStart : entry._firstCompleteHotStart)
+    {
+        out << hotStart.size();
+        for (int value : hotStart)
+            out << " " << value;
+        out << std::endl;
+    }
+
+    out << "#LAST" << std::endl;
+    out << entry._lastCompleteHotStart.size();
+    for (int value : entry._lastCompleteHotStart)
+        out << " " << value;
+    out << std::endl;
+
+    // the nested layout keeps the format independent of the memory layout
+    const Int3Array C(entry._C);
+    out << "#C " << C.size() << std::endl;
+    for (const IntMatrix& C_i : C)
+    {
+        out << C_i.size() << std::endl;
+        for (const IntArray& C_i_chr : C_i)
+        {
+            out << C_i_chr.size();
+            for (int value : C_i_chr)
+                out << " " << value;
+            out << std::endl;
+        }
+    }
+
+    out << "#M " << entry._M.size() << std::endl;
+    for (const DoubleArray& M_p : entry._M)
+    {
+        out << M_p.size();
+        for (double value : M_p)
+            out << " " << value;
+        out << std::endl;
+    }
+
+    // The tree is written in its own format, which has no end marker
+    std::stringstream tree;
+    tree << entry._T;
+    const std::string treeStr = tree.str();
+    out << "#TREE " << std::count(treeStr.begin(), treeStr.end(), '\n') << std::endl;
+    out << treeStr;
+
+    out.precision(precision);
+}
+
+
+void ResultCache::read(std::istream& in, Entry& entry)
+{
+    std::string tag;
+
+    in >> entry._objValue >> entry._bestSeed;
+
+    {
+        unsigned int size = 0;
+        in >> tag >> size;
+        if(tag != "#FIRST")
+            throw std::runtime_error("ERROR: expected #FIRST");
+        entry._firstCompleteHotStart = std::vector<HotStart>(size);
+        for (HotStart& hotStart : entry._firstCompleteHotStart)
+        {
+            unsigned int size_j = 0;
+            in >> size_j;
+            hotStart = HotStart(size_j);
+            for (unsigned int j = 0; j < size_j; ++j)
+                in >> hotStart[j];
+        }
+    }
+
+    {
+        unsigned int size = 0;
+        in >> tag >> size;
+        if(tag != "#LAST")
+            throw std::runtime_error("ERROR: expected #LAST");
+        entry._lastCompleteHotStart = HotStart(size);
+        for (unsigned int j = 0; j < size; ++j)
+            in >> entry._lastCompleteHotStart[j];
+    }
+
+    {
+        unsigned int size_i = 0;
+        in >> tag >> size_i;
+        if(tag != "#C")
+            throw std::runtime_error("ERROR: expected #C");
+        Int3Array C(size_i);
+        for (unsigned int i = 0; i < size_i; ++i)
+        {
+            unsigned int size_chr = 0;
+            in >> size_chr;
+            C[i] = IntMatrix(size_chr);
+            for (unsigned int chr = 0; chr < size_chr; ++chr)
+            {
+                unsigned int size_s = 0;
+                in >> size_s;
+                C[i][chr] = IntArray(size_s);
+                for (unsigned int s = 0; s < size_s; ++s)
+                    in >> C[i][chr][s];
+            }
+        }
+        // every chromosome has the same number of leaves, all of equal length
+        for (unsigned int chr = 0; chr < size_i; ++chr)
+        {
+            if (C[chr].size() != C[0].size())
+                throw std::runtime_error("ERROR: inconsistent #C");
+            for (unsigned int l = 0; l < C[chr].size(); ++l)
+            {
+                if (C[chr][l].size() != C[chr][0].size())
+                    throw std::runtime_error("ERROR: inconsistent #C");
+            }
+        }
+        entry._C = C;
+    }
+
+    {
+        unsigned int size_p = 0;
+        in >> tag >> size_p;
+        if(tag != "#M")
+            throw std::runtime_error("ERROR: expected #M");
+        entry._M = DoubleMatrix(size_p);
+        for (unsigned int p = 0; p < size_p; ++p)
+        {
+            unsigned int size_j = 0;
+            in >> size_j;
+            entry._M[p] = DoubleArray(size_j);
+            for (unsigned int j = 0; j < size_j; ++j)
+                in >> entry._M[p][j];
+        }
+    }
+
+    {
+        unsigned int nrLines = 0;
+        in >> tag >> nrLines;
+        if(tag != "#TREE")
+            throw std::runtime_error("ERROR: expected #TREE");
+
+        std::string line;
+        std::getline(in, line);
+
+        std::stringstream tree;
+        for (unsigned int l = 0; l < nrLines && std::getline(in, line); ++l)
+            tree << line << std::endl;
+        tree >> entry._T;
+    }
+
+    if(!in.good())
+    {
+        throw std::runtime_error("ERROR: truncated entry");
+    }
+}
+
+
+std::string ResultCache::hash(const std::string& str)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : str)
+    {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << h;
+    return ss.str();
+}
+
+
+std::string ResultCache::filename(const int Z) const
+{
+    std::stringstream ss;
+    ss << _directory << "/" << _hash << "." << Z;
+    return ss.str();
+}
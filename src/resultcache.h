@@ -0,0 +1,76 @@
+#ifndef _RESULTCACHE_H_
+#define _RESULTCACHE_H_
+
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "basic_types.h"
+#include "copynumbertree.h"
+
+/// This class stores the best solution found for a value of Z in a local
+/// directory, such that runs on the same instance with the same parameters
+/// can reuse it instead of launching the seeds again. The directory is
+/// content addressed: every entry is a file named after a hash of the input
+/// instance and of all the parameters that determine the result of a seed.
+class ResultCache
+{
+public:
+    /// Best solution for a value of Z
+    struct Entry
+    {
+        /// Distance
+        double _objValue;
+        /// Seed that attained the distance, -1 if unknown
+        int _bestSeed;
+        /// Copy-number tree
+        CopyNumberTree _T;
+        /// Copy numbers of the leaves
+        IntRaggedArray _C;
+        /// Usage matrix
+        DoubleMatrix _M;
+        /// Hot start obtained by the first iteration of each seed
+        std::vector<HotStart> _firstCompleteHotStart;
+        /// Hot start of the best solution
+        HotStart _lastCompleteHotStart;
+    };
+
+    /// Disabled cache
+    ResultCache();
+
+    /// Cache in directory for the instance and parameters serialized in key
+    ResultCache(const std::string& directory, const std::string& key);
+
+    bool enabled() const
+    {
+        return !_directory.empty();
+    }
+
+    /// Return true and fill entry if Z is in the cache
+    bool lookup(const int Z, Entry& entry) const;
+
+    /// Add or replace the entry of Z
+    void store(const int Z, const Entry& entry) const;
+
+    /// Write entry in text format
+    static void write(std::ostream& out, const Entry& entry);
+
+    /// Read an entry written by write, throws a runtime_error if malformed
+    static void read(std::istream& in, Entry& entry);
+
+    /// 64-bit FNV-1a hash of str in hexadecimal
+    static std::string hash(const std::string& str);
+
+private:
+    /// Filename of the entry of Z
+    std::string filename(const int Z) const;
+
+private:
+    /// Cache directory, empty if disabled
+    std::string _directory;
+    /// Hash of the instance and parameters
+    std::string _hash;
+};
+
+#endif // _RESULTCACHE_H_
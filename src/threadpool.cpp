@@ -0,0 +1,87 @@
+#include "threadpool.h"
+#include <cassert>
+#include <algorithm>
+
+ThreadPool::ThreadPool(const int nrThreads)
+    : _nrThreads(std::max(nrThreads, 1))
+    , _threads()
+    , _mutex()
+    , _taskAvailable()
+    , _idle()
+    , _queue()
+    , _nrRunning(0)
+    , _stop(false)
+{
+    for (int i = 0; i < _nrThreads; ++i)
+    {
+        _threads.create_thread(boost::bind(&ThreadPool::run, this));
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _taskAvailable.notify_all();
+    _threads.join_all();
+}
+
+
+void ThreadPool::submit(const Task& task)
+{
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+        _queue.push_back(task);
+    }
+    _taskAvailable.notify_one();
+}
+
+
+void ThreadPool::wait()
+{
+    boost::unique_lock<boost::mutex> lock(_mutex);
+    while (!_queue.empty() || _nrRunning > 0)
+    {
+        _idle.wait(lock);
+    }
+}
+
+
+void ThreadPool::run()
+{
+    while (true)
+    {
+        Task task;
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            while (_queue.empty() && !_stop)
+            {
+                _taskAvailable.wait(lock);
+            }
+
+            if (_queue.empty())
+            {
+                assert(_stop);
+                return;
+            }
+
+            task = _queue.front();
+            _queue.pop_front();
+            ++_nrRunning;
+        }
+
+        task();
+
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            --_nrRunning;
+            if (_queue.empty() && _nrRunning == 0)
+            {
+                _idle.notify_all();
+            }
+        }
+    }
+}
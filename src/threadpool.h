@@ -0,0 +1,52 @@
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include <deque>
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+
+/// Fixed set of long-lived worker threads consuming tasks from a shared queue.
+/// Threads are started once and reused, so tasks submitted for successive
+/// values of Z can run next to each other instead of behind a join barrier.
+class ThreadPool
+{
+public:
+    typedef boost::function<void()> Task;
+
+    ThreadPool(const int nrThreads);
+
+    ~ThreadPool();
+
+    /// Enqueue a task, it is picked up by the first idle thread
+    void submit(const Task& task);
+
+    /// Block until the queue is empty and no task is running
+    void wait();
+
+    int size() const
+    {
+        return _nrThreads;
+    }
+
+private:
+    /// Number of threads
+    const int _nrThreads;
+    /// Threads
+    boost::thread_group _threads;
+    /// Mutex protecting the queue and the counters
+    boost::mutex _mutex;
+    /// Signalled when a task is enqueued or the pool is stopped
+    boost::condition_variable _taskAvailable;
+    /// Signalled when the pool becomes idle
+    boost::condition_variable _idle;
+    /// Pending tasks
+    std::deque<Task> _queue;
+    /// Number of tasks currently running
+    int _nrRunning;
+    /// Set on destruction
+    bool _stop;
+
+    void run();
+};
+
+#endif // _THREADPOOL_H_
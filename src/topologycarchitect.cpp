@@ -0,0 +1,314 @@
+#include "topologycarchitect.h"
+#include <lemon/time_measure.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <map>
+#include <deque>
+
+
+TopologyCArchitect::TopologyCArchitect(const InputInstance& inputInstance,
+                                       const DoubleMatrix& M,
+                                       const IntMatrix& e,
+                                       const int Z,
+                                       const unsigned int k,
+                                       const bool rootNotFixed,
+                                       const bool forceDiploid,
+                                       const IntArray& parent)
+    : _inputInstance(inputInstance)
+    , _M(M)
+    , _e(e)
+    , _Z(Z)
+    , _k(k)
+    , _rootNotFixed(rootNotFixed)
+    , _forceDiploid(forceDiploid)
+    , _parent(parent)
+    , _numChr(inputInstance.numChr())
+    , _chrObjValue(_numChr, DoubleArray(Z + 1, 0.0))
+    , _chrT(_numChr, std::vector<CopyNumberTree>(Z + 1))
+    , _chrSolved(_numChr, 0)
+    , _budget(_numChr, 0)
+    , _T(k, inputInstance.numChr(), inputInstance.n())
+    , _objValue(0.0)
+    , _delta(0)
+    , _timer(0.0)
+{
+    assert(_parent.size() == 2*_k - 1);
+}
+
+bool TopologyCArchitect::solve(const int timeLimit, const int memoryLimit, const int nrThreads)
+{
+    // the normal diploid clone is the leaf k-1 and a child of the root
+    if (_forceDiploid && (_parent[1] != 0 || _parent[_k - 1] != 0))
+    {
+        return false;
+    }
+
+    if (g_verbosity >= VERBOSE_DEBUG)
+    {
+        std::cerr << ">> Start fixed-topology C-step" << std::endl;
+    }
+
+    lemon::Timer timer;
+
+    std::fill(_chrSolved.begin(), _chrSolved.end(), 0);
+    const unsigned int nrSolvers = std::max(1, std::min(nrThreads, (int)_numChr));
+    if (nrSolvers == 1)
+    {
+        solveChromosomes(0, 1, timeLimit, memoryLimit);
+    }
+    else
+    {
+        boost::thread_group threads;
+        for(unsigned int t = 0; t < nrSolvers; ++t)
+        {
+            threads.create_thread(boost::bind(&TopologyCArchitect::solveChromosomes, this,
+                                              t, nrSolvers, timeLimit, memoryLimit));
+        }
+        threads.join_all();
+    }
+
+    bool res = true;
+    for(unsigned int chr = 0; chr < _numChr; ++chr)
+    {
+        res &= (_chrSolved[chr] == 1);
+    }
+
+    if (res)
+    {
+        combine();
+    }
+
+    _timer = timer.realTime();
+
+    if (g_verbosity >= VERBOSE_DEBUG)
+    {
+        std::cerr << "Solution value = " << _objValue << std::endl;
+        std::cerr << "Runtime = " << _timer << " seconds" << std::endl;
+        std::cerr << ">> End fixed-topology C-step" << std::endl;
+    }
+
+    return res;
+}
+
+void TopologyCArchitect::solveChromosomes(const unsigned int chr, const unsigned int stride,
+                                          const int timeLimit, const int memoryLimit)
+{
+    for(unsigned int c = chr; c < _numChr; c += stride)
+    {
+        solveChromosome(c, timeLimit, memoryLimit);
+    }
+}
+
+void TopologyCArchitect::solveChromosome(const unsigned int chr, const int timeLimit, const int memoryLimit)
+{
+    const InputInstance instance = _inputInstance.chromosome(chr);
+    const IntMatrix e(1, _e[chr]);
+
+    CArchitect architect(instance, _M, e, 0, _k, _rootNotFixed, _forceDiploid);
+    architect.setTopology(_parent);
+    architect.init();
+
+    for(int b = 0; b <= _Z; ++b)
+    {
+        if (b > 0)
+        {
+            // a perfect fit cannot be improved by spending more events
+            if (!g_tol.nonZero(_chrObjValue[chr][b - 1]))
+            {
+                _chrObjValue[chr][b] = _chrObjValue[chr][b - 1];
+                _chrT[chr][b] = _chrT[chr][b - 1];
+                continue;
+            }
+
+            // the solution of budget b - 1 remains feasible
+            const HotStart hotStart = architect.getCompleteHotStart();
+            architect.updateZ(b);
+            architect.clearHotStarts();
+            architect.addCompleteHotStart(hotStart);
+        }
+
+        if (!architect.solve(timeLimit, memoryLimit, 1))
+        {
+            return;
+        }
+
+        _chrObjValue[chr][b] = architect.getObjValue();
+        _chrT[chr][b] = architect.getTree();
+    }
+
+    _chrSolved[chr] = 1;
+}
+
+void TopologyCArchitect::combine()
+{
+    // best[z] is the minimum distance of the chromosomes processed so far
+    // using at most z events, choice[chr][z] the budget of chr it attains
+    DoubleArray best(_Z + 1, 0.0);
+    IntMatrix choice(_numChr, IntArray(_Z + 1, 0));
+    for(unsigned int chr = 0; chr < _numChr; ++chr)
+    {
+        DoubleArray next(_Z + 1, 0.0);
+        for(int z = 0; z <= _Z; ++z)
+        {
+            next[z] = best[z] + _chrObjValue[chr][0];
+            for(int b = 1; b <= z; ++b)
+            {
+                const double value = best[z - b] + _chrObjValue[chr][b];
+                if (g_tol.less(value, next[z]))
+                {
+                    next[z] = value;
+                    choice[chr][z] = b;
+                }
+            }
+        }
+        best = next;
+    }
+
+    _objValue = best[_Z];
+    for(int chr = _numChr - 1, z = _Z; chr >= 0; --chr)
+    {
+        _budget[chr] = choice[chr][z];
+        z -= _budget[chr];
+    }
+
+    const int numVertices = 2*_k - 1;
+    _T = CopyNumberTree(_k, _numChr, _inputInstance.n());
+
+    // arcs in the order of CArchitect
+    for(int i = 0; i < (int)_k - 1; ++i)
+    {
+        for(int j = i + 1; j < numVertices; ++j)
+        {
+            if (_parent[j] == i)
+            {
+                _T.addArc(i, j);
+            }
+        }
+    }
+
+    for(int i = 0; i < numVertices; ++i)
+    {
+        CopyNumberTree::ProfileVector profile(_numChr);
+        for(unsigned int chr = 0; chr < _numChr; ++chr)
+        {
+            profile[chr] = _chrT[chr][_budget[chr]].profile(i)[0];
+        }
+        _T.setProfile(i, profile);
+    }
+
+    for(int j = 1; j < numVertices; ++j)
+    {
+        const int i = _parent[j];
+        for(unsigned int chr = 0; chr < _numChr; ++chr)
+        {
+            for (const CopyNumberTree::Event& event : _chrT[chr][_budget[chr]].events(i, j))
+            {
+                _T.addEvent(chr, i, j, CopyNumberTree::Event(chr, event._s, event._t, event._b));
+            }
+        }
+    }
+
+    _delta = _T.cost();
+}
+
+IntArray TopologyCArchitect::getTopology(const CopyNumberTree& T)
+{
+    const int numVertices = 2*T.k() - 1;
+    IntArray parent(numVertices, -1);
+    for(int j = 1; j < numVertices; ++j)
+    {
+        parent[j] = T.parent(j);
+    }
+    return parent;
+}
+
+const IntMatrix& TopologyCArchitect::enumerateTopologies(const unsigned int k)
+{
+    static boost::mutex mutex;
+    static std::map<unsigned int, IntMatrix> table;
+
+    boost::mutex::scoped_lock lock(mutex);
+    std::map<unsigned int, IntMatrix>::const_iterator it = table.find(k);
+    if (it != table.end())
+    {
+        return it->second;
+    }
+
+    IntMatrix& topologies = table[k];
+    if (k < 2)
+    {
+        return topologies;
+    }
+
+    // start from the tree on leaves 0 and 1 below the internal vertex k
+    IntArray tree(k + 1, -1);
+    tree[0] = k;
+    tree[1] = k;
+    enumerateTopologies(k, 2, tree, topologies);
+
+    return topologies;
+}
+
+void TopologyCArchitect::enumerateTopologies(const unsigned int k, const unsigned int l,
+                                             IntArray& tree, IntMatrix& topologies)
+{
+    const int size = tree.size();
+    if (l == k)
+    {
+        // renumber the internal vertices in breadth-first order
+        IntMatrix children(size);
+        int root = -1;
+        for(int v = 0; v < size; ++v)
+        {
+            if (tree[v] == -1)
+                root = v;
+            else
+                children[tree[v]].push_back(v);
+        }
+
+        IntArray index(size, -1);
+        int nextInternal = 0;
+        std::deque<int> queue(1, root);
+        while (!queue.empty())
+        {
+            const int v = queue.front();
+            queue.pop_front();
+            if (v < (int)k)
+            {
+                index[v] = k - 1 + v;
+            }
+            else
+            {
+                index[v] = nextInternal++;
+                queue.insert(queue.end(), children[v].begin(), children[v].end());
+            }
+        }
+
+        IntArray parent(2*k - 1, -1);
+        for(int v = 0; v < size; ++v)
+        {
+            if (tree[v] != -1)
+                parent[index[v]] = index[tree[v]];
+        }
+        topologies.push_back(parent);
+        return;
+    }
+
+    // the new internal vertex u subdivides the arc into v, or becomes the root
+    const int u = size;
+    tree.push_back(-1);
+    for(int v = 0; v < size; ++v)
+    {
+        if (v < (int)k && v >= (int)l)
+            continue;
+
+        const int parent_v = tree[v];
+        tree[u] = parent_v;
+        tree[v] = u;
+        tree[l] = u;
+        enumerateTopologies(k, l + 1, tree, topologies);
+        tree[v] = parent_v;
+        tree[l] = -1;
+    }
+    tree.pop_back();
+}
@@ -0,0 +1,128 @@
+#ifndef _TOPOLOGYCARCHITECT_H_
+#define _TOPOLOGYCARCHITECT_H_
+
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include <memory>
+
+#include "carchitect.h"
+#include "copynumbertree.h"
+#include "inputinstance.h"
+#include "basic_types.h"
+
+/// This class solves the C-step for a fixed tree topology. Once the x
+/// variables are fixed, the objective and all event constraints separate by
+/// chromosome and only the budget Z couples the chromosomes. Every chromosome
+/// is solved by its own CArchitect for each budget 0, ..., Z, chromosomes are
+/// solved in parallel, and the budgets are distributed over the chromosomes
+/// by a knapsack dynamic program.
+class TopologyCArchitect
+{
+public:
+    /// parent holds the parent of every vertex (-1 for the root), parents
+    /// must precede their children as in the x variables of BaseCArchitect
+    TopologyCArchitect(const InputInstance& inputInstance,
+                       const DoubleMatrix& M,
+                       const IntMatrix& e,
+                       const int Z,
+                       const unsigned int k,
+                       const bool rootNotFixed,
+                       const bool forceDiploid,
+                       const IntArray& parent);
+
+    /// Solve using at most nrThreads threads, every chromosome uses one
+    bool solve(const int timeLimit, const int memoryLimit, const int nrThreads);
+
+    double getObjValue() const
+    {
+        return _objValue;
+    }
+
+    /// Number of events of the solution
+    int getDelta() const
+    {
+        return _delta;
+    }
+
+    const CopyNumberTree& getTree() const
+    {
+        return _T;
+    }
+
+    IntRaggedArray getC() const
+    {
+        return _T.getLeafProfiles();
+    }
+
+    /// Budget assigned to each chromosome
+    const IntArray& getBudgets() const
+    {
+        return _budget;
+    }
+
+    double getTime() const
+    {
+        return _timer;
+    }
+
+    /// Parent of every vertex of T
+    static IntArray getTopology(const CopyNumberTree& T);
+
+    /// All (2k-3)!! rooted binary trees on the k labeled leaves, as parent
+    /// arrays with the internal vertices numbered in breadth-first order.
+    /// The table of each k is computed once and shared by all callers.
+    static const IntMatrix& enumerateTopologies(const unsigned int k);
+
+private:
+    /// Solve the chromosomes chr, chr + stride, chr + 2 stride, ...
+    void solveChromosomes(const unsigned int chr, const unsigned int stride,
+                          const int timeLimit, const int memoryLimit);
+    /// Solve chromosome chr for every budget
+    void solveChromosome(const unsigned int chr, const int timeLimit, const int memoryLimit);
+    /// Distribute the budget over the chromosomes
+    void combine();
+    /// Add leaf l to tree (parent array over leaves 0..k-1 and internal
+    /// vertices k, k+1, ...) in every possible way, store complete trees
+    static void enumerateTopologies(const unsigned int k, const unsigned int l,
+                                    IntArray& tree, IntMatrix& topologies);
+
+private:
+    /// Input instance
+    const InputInstance& _inputInstance;
+    /// Usage matrix
+    const DoubleMatrix& _M;
+    /// Maximum copy number per chromosome, per position
+    const IntMatrix& _e;
+    /// Maximum number of events
+    const int _Z;
+    /// Number of leaves
+    const unsigned int _k;
+    /// Do not fix the root to the normal diploid
+    const bool _rootNotFixed;
+    /// Force the presence of the normal diploid clone
+    const bool _forceDiploid;
+    /// Parent of every vertex
+    const IntArray _parent;
+    /// Number of chromosomes
+    const unsigned int _numChr;
+    /// Distance per chromosome, per budget
+    DoubleMatrix _chrObjValue;
+    /// Tree per chromosome, per budget
+    std::vector<std::vector<CopyNumberTree> > _chrT;
+    /// Convergence per chromosome (1 if solved)
+    IntArray _chrSolved;
+    /// Budget per chromosome
+    IntArray _budget;
+    /// Resulting copy number tree
+    CopyNumberTree _T;
+    /// Objective value
+    double _objValue;
+    /// Number of events
+    int _delta;
+    /// Running time of the last solve (seconds)
+    double _timer;
+};
+
+#endif // _TOPOLOGYCARCHITECT_H_
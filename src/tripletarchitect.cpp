@@ -163,13 +163,9 @@ void TripletArchitect::constructTree()
     }
     
     // construct events
-    const CopyNumberTree::Digraph& T = _T.T();
-    for (CopyNumberTree::ArcIt a_ij(T); a_ij != lemon::INVALID; ++a_ij)
+    for (int j = 1; j < (int)_num_vertices; ++j)
     {
-        CopyNumberTree::Node v_i = T.source(a_ij);
-        CopyNumberTree::Node v_j = T.target(a_ij);
-        const int i = _T.index(v_i);
-        const int j = _T.index(v_j);
+        const int i = _T.parent(j);
         const int remapped_j = remap_j(i, j);
         
         for (unsigned int chr = 0; chr < _num_chr; ++chr)
@@ -1,4 +1,7 @@
 #include "worker.h"
+#include <sstream>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 Worker::Worker(const InputInstance &inputInstance,
                const int k,
@@ -26,15 +29,28 @@ Worker::Worker(const InputInstance &inputInstance,
     , _memoryLimit(memoryLimit)
     , _nrThreads(nrThreads)
     , _M0(M0)
-    , _allC()
-    , _allM()
-    , _allObjC()
-    , _allObjM()
-    , _allTrees()
+    , _C()
+    , _M()
+    , _objC(0)
+    , _objM(0)
+    , _T()
     , _seedIndex(seedIndex)
     , _inputCompleteHotStart(inputCompleteHotStart)
     , _firstCompleteHotStart()
     , _lastCompleteHotStart()
+    , _carch()
+    , _march()
+    , _symmetryBreaking(false)
+    , _lazyConstraints(false)
+    , _enumerateTopologies(false)
+    , _poolSize(0)
+    , _candidates()
+    , _traceDirectory()
+    , _board(NULL)
+    , _terminationRatio(-1)
+    , _injectHotStarts(false)
+    , _nrIterations(0)
+    , _cutOff(false)
 {
 }
 
@@ -53,7 +69,7 @@ Worker::Worker(const InputInstance &inputInstance,
                const DoubleMatrix& M0,
                const int seedIndex)
     : Worker(inputInstance, k, e, Z, forceDiploid, rootNotFixed, iterConvergence,
-             maxIter, timeLimit, memoryLimit, nrThreads, M0, seedIndex, CArchitect::firstCompleteHotStart(inputInstance, e, k))
+             maxIter, timeLimit, memoryLimit, nrThreads, M0, seedIndex, CArchitect::firstCompleteHotStart(inputInstance, e, k, false))
 {
 }
 
@@ -63,34 +79,107 @@ double Worker::solve()
     unsigned int iter_convergence = 0;
     unsigned int iter = 0;
     bool first = true;
+    bool hopeless = false;
     
     HotStart completeHotStart = _inputCompleteHotStart;
-    
-    while((iter_convergence < _iterConvergence) && (iter < _maxIter))
+
+    std::ofstream trace;
+    if(!_traceDirectory.empty())
+    {
+        std::stringstream filename;
+        filename << _traceDirectory << "/" << _k << "." << _Z << "." << _seedIndex << ".trace";
+        trace.open(filename.str().c_str());
+        if(!trace.good())
+        {
+            throw std::runtime_error("ERROR: cannot write trace " + filename.str());
+        }
+    }
+
+    // the C-step model is built once, later iterations and later values of Z
+    // only update M and the budget row in place
+    if(!_enumerateTopologies)
     {
-        g_mutex.lock();
-        CArchitect carch(_inputInstance,
-                         _allM.empty() ? _M0 : _allM.back(),
-                         _e, _Z, _k, _rootNotFixed, _forceDiploid);
-        g_mutex.unlock();
-        
         try {
-            carch.init();
-            carch.addCompleteHotStart(completeHotStart);
-            bool status = carch.solve(_timeLimit, _memoryLimit, _nrThreads);
-            assert(status);
+            if(!_carch)
+            {
+                _carch.reset(new CArchitect(_inputInstance, _M0, _e, _Z, _k, _rootNotFixed, _forceDiploid));
+                _carch->setSymmetryBreaking(_symmetryBreaking);
+                _carch->setLazyConstraints(_lazyConstraints);
+                _carch->init();
+            }
+            else
+            {
+                _carch->updateZ(_Z);
+                _carch->updateM(_M0);
+            }
         } catch (IloException &e) {
             std::cerr << "ILOG exception: "<< e.getMessage() << std::endl;
             e.end();
             abort();
         }
-        assert(first || (g_tol.less(carch.getObjValue(), _allObjM.back()) | !g_tol.different(carch.getObjValue(), _allObjM.back())));
-        assert(first || (g_tol.less(carch.getObjValue(), _allObjC.back()) | !g_tol.different(carch.getObjValue(), _allObjC.back())));
+    }
 
-        _allObjC.push_back(carch.getObjValue());
-        _allC.push_back(carch.getC());
-        _allTrees.push_back(carch.getTree());
-        completeHotStart = carch.getCompleteHotStart();
+    while((iter_convergence < _iterConvergence) && (iter < _maxIter) && !hopeless)
+    {
+        double objC = 0, LB = 0, UB = 0, time = 0;
+        int delta = 0;
+        if(_enumerateTopologies)
+        {
+            // there is no model to hot start, the hot starts are passed on unchanged
+            std::unique_ptr<TopologyCArchitect> tarch(solveTopologies(first ? _M0 : _M));
+            if(!tarch)
+            {
+                throw std::runtime_error("ERROR: no topology is feasible in the C-step");
+            }
+            objC = LB = UB = tarch->getObjValue();
+            time = tarch->getTime();
+            delta = tarch->getDelta();
+            _C = tarch->getC();
+            _T = tarch->getTree();
+        }
+        else
+        {
+            CArchitect& carch = *_carch;
+            try {
+                if(!first)
+                {
+                    carch.updateM(_M);
+                }
+                carch.clearHotStarts();
+                carch.addCompleteHotStart(completeHotStart);
+                if(_board && _injectHotStarts && _board->getSeed() != _seedIndex)
+                {
+                    std::shared_ptr<const HotStart> incumbent = _board->getCompleteHotStart();
+                    if(incumbent)
+                    {
+                        carch.addCompleteHotStart(*incumbent);
+                    }
+                }
+                bool status = carch.solve(_timeLimit, _memoryLimit, _nrThreads);
+                assert(status);
+            } catch (IloException &e) {
+                std::cerr << "ILOG exception: "<< e.getMessage() << std::endl;
+                e.end();
+                abort();
+            }
+            objC = carch.getObjValue();
+            LB = carch.getLB();
+            UB = carch.getUB();
+            time = carch.getTime();
+            delta = carch.getDelta();
+            _C = carch.getC();
+            _T = carch.getTree();
+            completeHotStart = carch.getCompleteHotStart();
+
+            if(first && _poolSize > 0)
+            {
+                harvest(carch);
+            }
+        }
+        assert(first || (g_tol.less(objC, _objM) | !g_tol.different(objC, _objM)));
+        assert(first || (g_tol.less(objC, _objC) | !g_tol.different(objC, _objC)));
+
+        _objC = objC;
 
         if(first)
         {
@@ -103,31 +192,52 @@ double Worker::solve()
         {
             g_output_mutex.lock();
             std::cout << _k << "\t" << _Z << "\t" << _seedIndex << "\t"
-                      << iter << "\t" << "C" << "\t" << carch.getLB()
-                      << "\t" << carch.getUB() << "\t" << carch.getTime()
-                      << "\t" << carch.getDelta() << "\t" << carch.getObjValue() << std::endl;
+                      << iter << "\t" << "C" << "\t" << LB
+                      << "\t" << UB << "\t" << time
+                      << "\t" << delta << "\t" << objC << std::endl;
             g_output_mutex.unlock();
         }
         
-        g_mutex.lock();
-        MArchitect march(_inputInstance, _allC.back(), _k, _e);
-        g_mutex.unlock();
-
-        try {
-            march.init();
-            bool status = march.solve(_timeLimit, _memoryLimit);
-            assert(status);
-        } catch (IloException &e) {
-            std::cerr << "ILOG exception: "<< e.getMessage() << std::endl;
-            e.end();
-            abort();
+        // the M-step solver is built after the first C-step and updated in place afterwards
+        if(!_march)
+        {
+            _march.reset(new MSolver(_inputInstance, _C, _k));
         }
-        assert(g_tol.less(march.getObjValue(), _allObjC.back()) | !g_tol.different(carch.getObjValue(), _allObjC.back()));
-        
-        _allM.push_back(march.getM());
-        _allObjM.push_back(march.getObjValue());
+        else
+        {
+            _march->updateC(_C);
+        }
+        double LB_M = 0, UB_M = 0, time_M = 0;
+        if(_march->solve(_nrThreads))
+        {
+            _M = _march->getM();
+            _objM = _march->getObjValue();
+            LB_M = _march->getLB();
+            UB_M = _march->getUB();
+            time_M = _march->getTime();
+        }
+        else
+        {
+            // the LP is always feasible, fall back to CPLEX when the dual simplex gives up
+            try {
+                MArchitect march(_inputInstance, _C, _k, _e);
+                march.init();
+                bool status = march.solve(_timeLimit, _memoryLimit);
+                assert(status);
+                _M = march.getM();
+                _objM = march.getObjValue();
+                LB_M = march.getLB();
+                UB_M = march.getUB();
+                time_M = march.getTime();
+            } catch (IloException &e) {
+                std::cerr << "ILOG exception: "<< e.getMessage() << std::endl;
+                e.end();
+                abort();
+            }
+        }
+        assert(g_tol.less(_objM, _objC) | !g_tol.different(objC, _objC));
         
-        if(g_tol.different(_allObjM.back(), _allObjC.back())) {
+        if(g_tol.different(_objM, _objC)) {
             iter_convergence = 0;
         } else {
             ++iter_convergence;
@@ -137,20 +247,184 @@ double Worker::solve()
         {
             g_output_mutex.lock();
             std::cout << _k << "\t" << _Z << "\t" << _seedIndex << "\t"
-                      << iter << "\t" << "M" << "\t" << march.getLB()
-                      << "\t" << march.getUB() << "\t" << march.getTime()
-                      << "\t" << carch.getDelta() << "\t" << march.getObjValue() << std::endl;
+                      << iter << "\t" << "M" << "\t" << LB_M
+                      << "\t" << UB_M << "\t" << time_M
+                      << "\t" << delta << "\t" << _objM << std::endl;
             g_output_mutex.unlock();
         }
+
+        if(trace.is_open())
+        {
+            writeTrace(trace, iter, delta);
+        }
+
+        if(_board)
+        {
+            _board->post(_objM, _seedIndex, completeHotStart);
+
+            // coordinate descent only decreases the distance, but a seed this
+            // far above the incumbent is not expected to catch up
+            const double incumbent = _board->getObjValue();
+            hopeless = _terminationRatio > 0 && g_tol.less(_terminationRatio * incumbent, _objM);
+            if(hopeless && g_verbosity >= VERBOSE_NON_ESSENTIAL)
+            {
+                g_output_mutex.lock();
+                std::cout << _k << "\t" << _Z << "\t" << _seedIndex << "\t"
+                          << iter << "\t" << "STOP" << "\t" << incumbent << std::endl;
+                g_output_mutex.unlock();
+            }
+        }
         
         ++iter;
     }
-    assert(iter_convergence >= _iterConvergence | iter == _maxIter);
+    assert(iter_convergence >= _iterConvergence | iter == _maxIter | hopeless);
     
+    _nrIterations = iter;
+    _cutOff = hopeless;
     _lastCompleteHotStart = completeHotStart;
-    return _allObjM.back();
+    return _objM;
 }
 
 
+void Worker::updateZ(const int Z, const HotStart& inputCompleteHotStart)
+{
+    _Z = Z;
+    _inputCompleteHotStart = inputCompleteHotStart;
+    _C = IntRaggedArray();
+    _M.clear();
+    _objC = 0;
+    _objM = 0;
+    _T = CopyNumberTree();
+    _firstCompleteHotStart.clear();
+    _lastCompleteHotStart.clear();
+    _candidates.clear();
+    _nrIterations = 0;
+    _cutOff = false;
+}
+
 
+void Worker::writeTrace(std::ostream& trace, const unsigned int iter, const int delta) const
+{
+    const std::streamsize precision = trace.precision(std::numeric_limits<double>::max_digits10);
+
+    trace << "#ITERATION " << iter << " " << _objC << " " << delta << " " << _objM << std::endl;
+
+    // the tree is written in its own format, which has no end marker
+    std::stringstream tree;
+    tree << _T;
+    const std::string treeStr = tree.str();
+    trace << "#TREE " << std::count(treeStr.begin(), treeStr.end(), '\n') << std::endl;
+    trace << treeStr;
+
+    trace << "#M " << _M.size() << std::endl;
+    for (const DoubleArray& M_p : _M)
+    {
+        trace << M_p.size();
+        for (double value : M_p)
+            trace << " " << value;
+        trace << std::endl;
+    }
 
+    trace.precision(precision);
+    trace.flush();
+}
+
+
+void Worker::harvest(CArchitect& carch)
+{
+    // pool solutions by increasing C-step objective, the incumbent is the first
+    const int nrSolutions = carch.getNumPoolSolutions();
+    std::vector<std::pair<double, int> > order;
+    for(int soln = 0; soln < nrSolutions; ++soln)
+    {
+        order.push_back(std::make_pair(carch.getObjValue(soln), soln));
+    }
+    std::sort(order.begin(), order.end());
+
+    // solutions with the same leaves lead to the same M-step
+    std::vector<IntRaggedArray> harvestedC(1, _C);
+    _candidates.clear();
+    for(unsigned int idx = 0; idx < order.size() && (int)_candidates.size() < _poolSize; ++idx)
+    {
+        const int soln = order[idx].second;
+        const IntRaggedArray C = carch.getC(soln);
+        if(std::find(harvestedC.begin(), harvestedC.end(), C) != harvestedC.end())
+            continue;
+        harvestedC.push_back(C);
+
+        MSolver march(_inputInstance, C, _k);
+        if(!march.solve(_nrThreads))
+            continue;
+
+        Candidate candidate;
+        candidate._objValue = march.getObjValue();
+        candidate._M = march.getM();
+        candidate._completeHotStart = carch.getCompleteHotStart(soln);
+        _candidates.push_back(candidate);
+    }
+
+    std::stable_sort(_candidates.begin(), _candidates.end());
+}
+
+
+std::unique_ptr<TopologyCArchitect> Worker::solveTopologies(const DoubleMatrix& M) const
+{
+    const IntMatrix& topologies = TopologyCArchitect::enumerateTopologies(_k);
+
+    const unsigned int nrSolvers = std::max(1, std::min(_nrThreads, (int)topologies.size()));
+    std::vector<std::unique_ptr<TopologyCArchitect> > best(nrSolvers);
+    if (nrSolvers == 1)
+    {
+        solveTopologies(0, 1, M, best[0]);
+    }
+    else
+    {
+        boost::thread_group threads;
+        for(unsigned int t = 0; t < nrSolvers; ++t)
+        {
+            threads.create_thread(boost::bind(&Worker::solveTopologies, this, t, nrSolvers,
+                                              boost::cref(M), boost::ref(best[t])));
+        }
+        threads.join_all();
+    }
+
+    std::unique_ptr<TopologyCArchitect> result;
+    for(unsigned int t = 0; t < nrSolvers; ++t)
+    {
+        if(best[t] && (!result || g_tol.less(best[t]->getObjValue(), result->getObjValue())))
+        {
+            result = std::move(best[t]);
+        }
+    }
+    return result;
+}
+
+
+void Worker::solveTopologies(const unsigned int t, const unsigned int stride, const DoubleMatrix& M,
+                             std::unique_ptr<TopologyCArchitect>& best) const
+{
+    const IntMatrix& topologies = TopologyCArchitect::enumerateTopologies(_k);
+    for(unsigned int i = t; i < topologies.size(); i += stride)
+    {
+        // the normal diploid clone is the leaf k-1 and a child of the root
+        if(_forceDiploid && (topologies[i][1] != 0 || topologies[i][_k - 1] != 0))
+            continue;
+
+        std::unique_ptr<TopologyCArchitect> tarch(new TopologyCArchitect(_inputInstance, M, _e, _Z, _k,
+                                                                         _rootNotFixed, _forceDiploid,
+                                                                         topologies[i]));
+        try {
+            if(!tarch->solve(_timeLimit, _memoryLimit, 1))
+                continue;
+        } catch (IloException &e) {
+            std::cerr << "ILOG exception: "<< e.getMessage() << std::endl;
+            e.end();
+            abort();
+        }
+
+        if(!best || g_tol.less(tarch->getObjValue(), best->getObjValue()))
+        {
+            best = std::move(tarch);
+        }
+    }
+}
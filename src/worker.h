@@ -7,15 +7,35 @@
 #include <stdlib.h>
 #include <cstdlib>
 #include <algorithm>
+#include <memory>
 
 #include "basic_types.h"
 #include "carchitect.h"
+#include "topologycarchitect.h"
+#include "msolver.h"
 #include "marchitect.h"
 #include "inputinstance.h"
+#include "incumbentboard.h"
 
 class Worker
 {
 public:
+    /// Starting point harvested from the solution pool of the first C-step
+    struct Candidate
+    {
+        /// Distance after the M-step
+        double _objValue;
+        /// Usage matrix of the M-step
+        DoubleMatrix _M;
+        /// Complete HotStart of the pool solution
+        HotStart _completeHotStart;
+
+        bool operator<(const Candidate& other) const
+        {
+            return _objValue < other._objValue;
+        }
+    };
+
     Worker(const InputInstance &inputInstance,
            const int k,
            const IntMatrix& e,
@@ -47,20 +67,98 @@ public:
     
     /// Solve for given seed M0
     double solve();
+
+    /// Add symmetry-breaking constraints to the C-step model, to be set before solve()
+    void setSymmetryBreaking(const bool symmetryBreaking)
+    {
+        _symmetryBreaking = symmetryBreaking;
+    }
+
+    /// Keep the arc-conditional rows of the C-step model in the lazy
+    /// constraint pool, to be set before solve()
+    void setLazyConstraints(const bool lazyConstraints)
+    {
+        _lazyConstraints = lazyConstraints;
+    }
+
+    /// Solve every C-step by enumerating all tree topologies instead of the
+    /// full model, to be set before solve()
+    void setEnumerateTopologies(const bool enumerateTopologies)
+    {
+        _enumerateTopologies = enumerateTopologies;
+    }
+
+    /// Harvest up to poolSize distinct solutions from the solution pool of
+    /// the first C-step besides the incumbent, to be set before solve()
+    void setPoolSize(const int poolSize)
+    {
+        _poolSize = poolSize;
+    }
+
+    /// Write the tree, the usage matrix and the distances of every iteration
+    /// to a file of its own in directory, to be set before solve()
+    void setTraceDirectory(const std::string& directory)
+    {
+        _traceDirectory = directory;
+    }
+
+    /// Post the distance after every M-step to board, shared with the other
+    /// seeds of the same Z, to be set before solve()
+    void setIncumbentBoard(IncumbentBoard* board)
+    {
+        _board = board;
+    }
+
+    /// Stop as soon as the distance after an M-step exceeds terminationRatio
+    /// times the incumbent of the board, disabled if not positive
+    void setTerminationRatio(const double terminationRatio)
+    {
+        _terminationRatio = terminationRatio;
+    }
+
+    /// Add the hot start of the incumbent of the board to every C-step
+    void setInjectHotStarts(const bool injectHotStarts)
+    {
+        _injectHotStarts = injectHotStarts;
+    }
+
+    /// Number of coordinate-descent iterations of the last solve
+    unsigned int getNrIterations() const
+    {
+        return _nrIterations;
+    }
+
+    /// True if the last solve stopped because its distance exceeded the
+    /// termination ratio times the incumbent of the board
+    bool isCutOff() const
+    {
+        return _cutOff;
+    }
+
+    /// Candidates harvested by the last solve, by increasing distance
+    const std::vector<Candidate>& getCandidates() const
+    {
+        return _candidates;
+    }
+
+    /// Prepare the next solve for a different maximum number of events,
+    /// starting again from M0 and from the given complete HotStart. The
+    /// C-step model and the M-step solver of the previous solve are kept.
+    void updateZ(const int Z, const HotStart& inputCompleteHotStart);
     
-    const Int3Array& getC() const
+    const IntRaggedArray& getC() const
     {
-        return _allC.back();
+        return _C;
     }
     
     const DoubleMatrix& getM() const
     {
-        return _allM.back();
+        return _M;
     }
     
     const CopyNumberTree& getT() const
     {
-        return _allTrees.back();
+        return _T;
     }
 
     const HotStart& getFirstCompleteHotStart()
@@ -73,6 +171,38 @@ public:
         return _lastCompleteHotStart;
     }
 
+    /// The take accessors move the results of the last solve out of the
+    /// worker, which can only be solved again after updateZ
+    IntRaggedArray takeC()
+    {
+        return std::move(_C);
+    }
+
+    DoubleMatrix takeM()
+    {
+        return std::move(_M);
+    }
+
+    CopyNumberTree takeT()
+    {
+        return std::move(_T);
+    }
+
+    HotStart takeFirstCompleteHotStart()
+    {
+        return std::move(_firstCompleteHotStart);
+    }
+
+    HotStart takeLastCompleteHotStart()
+    {
+        return std::move(_lastCompleteHotStart);
+    }
+
+    std::vector<Candidate> takeCandidates()
+    {
+        return std::move(_candidates);
+    }
+
 private:
     /// Input instance
     const InputInstance& _inputInstance;
@@ -81,7 +211,7 @@ private:
     /// Maximum copy number per chromosome, per position
     const IntMatrix& _e;
     /// Maximum number of events per all chromosomes
-    const int _Z;
+    int _Z;
     /// Force the presence of the normal diploid clone
     const bool _forceDiploid;
     /// Do not fix the root to the normal diploid
@@ -98,24 +228,62 @@ private:
     const int _nrThreads;
     /// Initial M0
     const DoubleMatrix& _M0;
-    /// All C matrices
-    std::vector<Int3Array> _allC;
-    /// All M matrices
-    std::vector<DoubleMatrix> _allM;
-    /// All objective values for the C-steps
-    DoubleArray _allObjC;
-    /// All objective values for the M-steps
-    DoubleArray _allObjM;
-    /// All the trees
-    std::vector<CopyNumberTree> _allTrees;
+    /// C of the last C-step
+    IntRaggedArray _C;
+    /// M of the last M-step, the input of the next C-step
+    DoubleMatrix _M;
+    /// Objective value of the last C-step
+    double _objC;
+    /// Objective value of the last M-step
+    double _objM;
+    /// Tree of the last C-step
+    CopyNumberTree _T;
     /// Seed index
     const int _seedIndex;
     ///The complete HotStart that is used to hotstart the process
-    const HotStart _inputCompleteHotStart;
+    HotStart _inputCompleteHotStart;
     ///The complete HotStart that is computed after the first iteration
     HotStart _firstCompleteHotStart;
     ///The last complete HotStart
     HotStart _lastCompleteHotStart;
+    /// C-step model, built by the first solve
+    std::unique_ptr<CArchitect> _carch;
+    /// M-step solver, built after the first C-step
+    std::unique_ptr<MSolver> _march;
+    /// Add symmetry-breaking constraints to the C-step model
+    bool _symmetryBreaking;
+    /// Keep the arc-conditional rows of the C-step model in the lazy constraint pool
+    bool _lazyConstraints;
+    /// Solve every C-step by enumerating all tree topologies
+    bool _enumerateTopologies;
+    /// Number of pool solutions to harvest from the first C-step
+    int _poolSize;
+    /// Candidates harvested from the first C-step
+    std::vector<Candidate> _candidates;
+    /// Directory of the iteration traces, empty if disabled
+    std::string _traceDirectory;
+    /// Incumbent of the seeds of the same Z, null if not shared
+    IncumbentBoard* _board;
+    /// Ratio to the incumbent above which the seed stops, disabled if not positive
+    double _terminationRatio;
+    /// Add the hot start of the incumbent to every C-step
+    bool _injectHotStarts;
+    /// Number of iterations of the last solve
+    unsigned int _nrIterations;
+    /// The last solve stopped because it was too far above the incumbent
+    bool _cutOff;
+
+    /// Write the tree, the usage matrix and the distances of iteration iter to trace
+    void writeTrace(std::ostream& trace, const unsigned int iter, const int delta) const;
+
+    /// Harvest the candidates from the solution pool of carch
+    void harvest(CArchitect& carch);
+
+    /// Solve the C-step for M over all topologies, return the best or null if none is feasible
+    std::unique_ptr<TopologyCArchitect> solveTopologies(const DoubleMatrix& M) const;
+    /// Solve the topologies t, t + stride, t + 2 stride, ... and keep the best in best
+    void solveTopologies(const unsigned int t, const unsigned int stride, const DoubleMatrix& M,
+                         std::unique_ptr<TopologyCArchitect>& best) const;
 };
 
 
@@ -196,3 +196,73 @@ const InputInstance makeCompleteFracInstance(const unsigned int num_chr, const u
 
     return instance;
 }
+
+
+const InputInstance makeUnevenIntInstance(const unsigned int num_chr, const unsigned int num_sam)
+{
+    // the profiles of makeCompleteIntInstance, chromosome c keeps its first 6 - c%5 segments
+    const DoubleMatrix profiles = {{0, 2.0, 2.0, 2.0, 3.0, 3.0},
+                                   {0, 2.0, 1.0, 2.0, 2.0, 2.0},
+                                   {4.0, 0, 0, 0, 0, 0},
+                                   {2.0, 0, 0, 0, 0, 0}};
+
+    std::stringstream input;
+    input << "#PARAMS" << std::endl;
+    input << num_chr << " #number of chromosomes" << std::endl;
+    input << num_sam << " #number of samples" << std::endl;
+    for(unsigned int c = 0; c < num_chr; ++c)
+    {
+        input << 6 - c%5;
+        if(c != num_chr-1)
+            input << " ";
+    }
+    input << " #number of segments for each chromosome" << std::endl;
+
+    input << "#SAMPLES" << std::endl;
+    for(unsigned int i = 0; i < num_sam; ++i)
+    {
+        input << "S" << i+1 << " :";
+        for(unsigned int c = 0; c < num_chr; ++c)
+        {
+            for(unsigned int s = 0; s < 6 - c%5; ++s)
+            {
+                input << " " << profiles[i%4][s];
+            }
+            if(c < num_chr - 1)
+            {
+                input << " |";
+            }
+        }
+        input << std::endl;
+    }
+
+    InputInstance instance;
+    input >> instance;
+
+    return instance;
+}
+
+
+const DoubleMatrix makeCyclicM(const unsigned int num_sam, const unsigned int num_leaves)
+{
+    // sample p consists of leaf p % num_leaves only
+    DoubleMatrix M(num_sam, DoubleArray(num_leaves, 0.0));
+    for(unsigned int p = 0; p < num_sam; ++p)
+    {
+        M[p][p%num_leaves] = 1.0;
+    }
+
+    return M;
+}
+
+
+const IntMatrix makeMaxCN(const InputInstance& instance, const int max_cn)
+{
+    IntMatrix e;
+    for(unsigned int c = 0; c < instance.numChr(); ++c)
+    {
+        e.push_back(IntArray(instance.n()[c], max_cn));
+    }
+
+    return e;
+}
@@ -47,4 +47,7 @@ const InputInstance makeAllEqualInstance(const unsigned int num_chr, const unsig
                                          const unsigned int num_seg, const double value);
 const InputInstance makeCompleteIntInstance(const unsigned int num_chr, const unsigned int num_sam);
 const InputInstance makeCompleteFracInstance(const unsigned int num_chr, const unsigned int num_sam);
+const InputInstance makeUnevenIntInstance(const unsigned int num_chr, const unsigned int num_sam);
+const DoubleMatrix makeCyclicM(const unsigned int num_sam, const unsigned int num_leaves);
+const IntMatrix makeMaxCN(const InputInstance& instance, const int max_cn);
 
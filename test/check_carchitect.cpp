@@ -1,5 +1,7 @@
 #include "basic_check.h"
 #include "carchitect.h"
+#include "topologycarchitect.h"
+#include "fmcsolution.h"
 
 int checkAllDiploid();
 const ReturnMessage testAllDiploid(const int num_chr, const int num_sam, const int num_seg,
@@ -12,6 +14,33 @@ int checkFullExampleHalf4Clones();
 const ReturnMessage testFullExampleHalf4Clones(const int num_chr, const int max_cn,
                                                const int max_e);
 
+int checkUpdateM();
+const ReturnMessage testUpdateM(const InputInstance& instance, const int num_leaves,
+                                const int max_cn, const int max_e);
+int checkUpdateZ();
+int checkSymmetryBreaking();
+int checkCompression();
+const ReturnMessage testCompression(const InputInstance& instance, const int num_leaves,
+                                    const int max_cn, const int max_e, const double tol);
+int checkFixedTopology();
+const ReturnMessage testFixedTopology(const InputInstance& instance, const int num_leaves,
+                                      const int max_cn, const int max_e);
+int checkEnumeration();
+const ReturnMessage testEnumeration(const InputInstance& instance, const int num_leaves,
+                                    const int max_cn, const int max_e);
+int checkLazyConstraints();
+const ReturnMessage testLazyConstraints(const InputInstance& instance, const int num_leaves,
+                                        const int max_cn, const int max_e);
+int checkBoundTightening();
+const ReturnMessage testBoundTightening(const int num_chr);
+int checkRemoveDiploid();
+const ReturnMessage testRemoveDiploid(const InputInstance& instance, const int num_leaves,
+                                      const int max_cn, const int max_e, const double tol);
+const ReturnMessage testSymmetryBreaking(const InputInstance& instance, const int num_leaves,
+                                         const int max_cn, const int max_e);
+const ReturnMessage testUpdateZ(const InputInstance& instance, const int num_leaves,
+                                const int max_cn, const int first_e, const int max_e);
+
 
 int main(int argc, char** argv)
 {
@@ -24,6 +53,24 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     if(checkFullExampleHalf4Clones() == EXIT_FAILURE)
         return EXIT_FAILURE;
+    if(checkUpdateM() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkUpdateZ() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkSymmetryBreaking() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkCompression() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkRemoveDiploid() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkFixedTopology() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkEnumeration() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkLazyConstraints() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkBoundTightening() == EXIT_FAILURE)
+        return EXIT_FAILURE;
 
     return EXIT_SUCCESS;
 }
@@ -879,3 +926,839 @@ const ReturnMessage testFullExampleHalf4Clones(const int num_chr, const int max_
     return ReturnMessage(ReturnType::SUCCESS);
 }
 
+
+int checkUpdateM()
+{
+    {
+        ReturnMessage m(testUpdateM(makeCompleteIntInstance(1, 4), 4, 4, 3*1));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testUpdateM(makeCompleteFracInstance(2, 6), 4, 4, 3*2));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testUpdateM(const InputInstance& instance, const int num_leaves,
+                                const int max_cn, const int max_e)
+{
+    std::cout << "- Check update of M in place with " << instance.numChr() << " chromosomes, "
+              << instance.m() << " samples, " << num_leaves << " leaves, max cn of " << max_cn
+              << ", and max events of " << max_e << " : ";
+
+    const DoubleMatrix M0(instance.m(), DoubleArray(num_leaves, 1.0 / num_leaves));
+    const DoubleMatrix M1 = makeCyclicM(instance.m(), num_leaves);
+    const IntMatrix MAX_CN = makeMaxCN(instance, max_cn);
+
+    CArchitect updated(instance, M0, MAX_CN, max_e, num_leaves, false, false);
+    updated.init();
+    updated.solve(0,0,0);
+    const int numRows = updated.getNumRows();
+    updated.updateM(M1);
+    updated.clearHotStarts();
+    updated.solve(0,0,0);
+
+    // only the coefficients of the fit rows change
+    if(updated.getNumRows() != numRows)
+        return ReturnMessage(ReturnType::FAILURE, "Updating M added rows to the model");
+
+    CArchitect fresh(instance, M1, MAX_CN, max_e, num_leaves, false, false);
+    fresh.init();
+    fresh.solve(0,0,0);
+
+    if(g_tol.different(updated.getObjValue(), fresh.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The objective after updating M differs from a model built with the same M");
+
+    if(updated.getDelta() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The number of events is greater than the imposed upper bound");
+
+    if(updated.getTree().cost() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The tree of the re-solved model is inconsistent");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkUpdateZ()
+{
+    {
+        ReturnMessage m(testUpdateZ(makeCompleteIntInstance(1, 4), 4, 4, 0, 3*1));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testUpdateZ(makeCompleteFracInstance(2, 6), 4, 4, 3*2, 1*2));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testUpdateZ(const InputInstance& instance, const int num_leaves,
+                                const int max_cn, const int first_e, const int max_e)
+{
+    std::cout << "- Check update of Z in place with " << instance.numChr() << " chromosomes, "
+              << instance.m() << " samples, " << num_leaves << " leaves, max cn of " << max_cn
+              << ", and max events from " << first_e << " to " << max_e << " : ";
+
+    const DoubleMatrix M = makeCyclicM(instance.m(), num_leaves);
+    const IntMatrix MAX_CN = makeMaxCN(instance, max_cn);
+
+    CArchitect updated(instance, M, MAX_CN, first_e, num_leaves, false, false);
+    updated.init();
+    updated.solve(0,0,0);
+    const HotStart incumbent = updated.getCompleteHotStart();
+    const double firstObj = updated.getObjValue();
+    const int numRows = updated.getNumRows();
+    updated.updateZ(max_e);
+    updated.clearHotStarts();
+    if(first_e <= max_e)
+        updated.addCompleteHotStart(incumbent);
+    updated.solve(0,0,0);
+
+    // only the right hand side of the budget row changes
+    if(updated.getNumRows() != numRows)
+        return ReturnMessage(ReturnType::FAILURE, "Updating Z added rows to the model");
+
+    // a larger budget can only decrease the distance, a smaller one only increase it
+    if(first_e <= max_e ? g_tol.less(firstObj, updated.getObjValue()) : g_tol.less(updated.getObjValue(), firstObj))
+        return ReturnMessage(ReturnType::FAILURE, "The objective after updating Z moved against the budget");
+
+    CArchitect fresh(instance, M, MAX_CN, max_e, num_leaves, false, false);
+    fresh.init();
+    fresh.solve(0,0,0);
+
+    if(g_tol.different(updated.getObjValue(), fresh.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The objective after updating Z differs from a model built with the same Z");
+
+    if(updated.getDelta() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The number of events is greater than the updated upper bound");
+
+    if(updated.getTree().cost() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The tree of the re-solved model is inconsistent");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkSymmetryBreaking()
+{
+    {
+        ReturnMessage m(testSymmetryBreaking(makeCompleteIntInstance(1, 4), 5, 4, 3*1));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testSymmetryBreaking(makeCompleteFracInstance(2, 6), 6, 4, 3*2));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testSymmetryBreaking(const InputInstance& instance, const int num_leaves,
+                                         const int max_cn, const int max_e)
+{
+    std::cout << "- Check symmetry breaking with " << instance.numChr() << " chromosomes, "
+              << instance.m() << " samples, " << num_leaves << " leaves, max cn of " << max_cn
+              << ", and max events of " << max_e << " : ";
+
+    const int num_sam = instance.m();
+
+    DoubleMatrix M(num_sam, DoubleArray(num_leaves, 0.0));
+    for(unsigned int p = 0; p < num_sam; ++p)
+    {
+        M[p][p%num_leaves] = 0.5;
+        M[p][(p+1)%num_leaves] += 0.5;
+    }
+
+    const IntMatrix MAX_CN = makeMaxCN(instance, max_cn);
+
+    CArchitect plain(instance, M, MAX_CN, max_e, num_leaves, false, false);
+    plain.init();
+    plain.solve(0,0,0);
+
+    CArchitect broken(instance, M, MAX_CN, max_e, num_leaves, false, false);
+    broken.setSymmetryBreaking(true);
+    broken.init();
+    broken.addCompleteHotStart(CArchitect::firstCompleteHotStart(instance, MAX_CN, num_leaves, true));
+    broken.solve(0,0,0);
+
+    if(g_tol.different(plain.getObjValue(), broken.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The objective with symmetry breaking differs from the one without");
+
+    if(broken.getDelta() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The number of events is greater than the imposed upper bound");
+
+    if(broken.getTree().cost() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The tree with symmetry breaking is inconsistent");
+
+    // the internal vertices are numbered in the order of their parents
+    for(int j = 1; j + 1 < num_leaves - 1; ++j)
+    {
+        if(broken.getTree().parent(j) > broken.getTree().parent(j + 1))
+        {
+            std::stringstream message;
+            message << "The parent of internal vertex " << j << " comes after the parent of " << j + 1;
+            return ReturnMessage(ReturnType::FAILURE, message.str());
+        }
+    }
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkCompression()
+{
+    {
+        ReturnMessage m(testCompression(makeCompleteIntInstance(1, 4), 4, 4, 3*1, 0.0));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testCompression(makeCompleteFracInstance(2, 6), 4, 4, 3*2, 0.0));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testCompression(makeCompleteFracInstance(2, 6), 4, 4, 3*2, 0.1));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testCompression(const InputInstance& instance, const int num_leaves,
+                                    const int max_cn, const int max_e, const double tol)
+{
+    std::cout << "- Check compression of repeated segments with " << instance.numChr() << " chromosomes, "
+              << instance.m() << " samples, " << num_leaves << " leaves, max cn of " << max_cn
+              << ", max events of " << max_e << ", and tolerance " << tol << " : ";
+
+    // every segment of instance is repeated twice, the copy being shifted by
+    // half the tolerance so that compression still merges the pair
+    std::stringstream input;
+    input << "#PARAMS" << std::endl;
+    input << instance.numChr() << " #number of chromosomes" << std::endl;
+    input << instance.m() << " #number of samples" << std::endl;
+    for(unsigned int c = 0; c < instance.numChr(); ++c)
+    {
+        input << 2 * instance.n()[c] << " ";
+    }
+    input << "#number of segments for each chromosome" << std::endl;
+    input << "#SAMPLES" << std::endl;
+    for(unsigned int p = 0; p < instance.m(); ++p)
+    {
+        input << "S" << p+1 << ":";
+        for(unsigned int c = 0; c < instance.numChr(); ++c)
+        {
+            if (c != 0)
+            {
+                input << " |";
+            }
+            for(unsigned int s = 0; s < instance.n()[c]; ++s)
+            {
+                input << " " << instance.F()[c][p][s] << " " << instance.F()[c][p][s] + tol / 2;
+            }
+        }
+        input << std::endl;
+    }
+
+    InputInstance repeated;
+    input >> repeated;
+    const InputInstance compressed = repeated.compress(tol);
+
+    if(compressed.numSegments() != repeated.numSegments())
+        return ReturnMessage(ReturnType::FAILURE, "The weights of the compressed instance do not cover the input segments");
+
+    // each segment of instance and its repeat are within the tolerance in every sample
+    for(unsigned int c = 0; c < instance.numChr(); ++c)
+    {
+        if(compressed.n()[c] > instance.n()[c])
+            return ReturnMessage(ReturnType::FAILURE, "The repeated segments have not been merged");
+    }
+
+    const DoubleMatrix M = makeCyclicM(instance.m(), num_leaves);
+    const IntMatrix MAX_CN_repeated = makeMaxCN(repeated, max_cn);
+    const IntMatrix MAX_CN_compressed = makeMaxCN(compressed, max_cn);
+
+    CArchitect full(repeated, M, MAX_CN_repeated, max_e, num_leaves, false, false);
+    full.init();
+    full.solve(0,0,0);
+
+    CArchitect merged(compressed, M, MAX_CN_compressed, max_e, num_leaves, false, false);
+    merged.init();
+    merged.solve(0,0,0);
+
+    if(tol == 0 && g_tol.different(full.getObjValue(), merged.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The objective of the compressed instance differs from the one of the input");
+
+    const CopyNumberTree expanded = merged.getTree().expand(compressed.w());
+    if(expanded.n() != repeated.n())
+        return ReturnMessage(ReturnType::FAILURE, "The expanded tree does not have the segmentation of the input");
+
+    if(expanded.cost() != merged.getTree().cost() || expanded.cost() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The expanded tree has a different number of events");
+
+    // the distance of the expanded tree is measured on the input segments:
+    // it bounds the merged objective from above and cannot beat the full optimum
+    const double distance = FMCSolution(expanded, M, repeated).getObjValue();
+    if(g_tol.less(distance, merged.getObjValue()) || g_tol.less(distance, full.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The distance of the expanded tree is below the optimum of the input");
+
+    if(tol == 0 && g_tol.different(distance, merged.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The distance of the expanded tree differs from the objective of the compressed instance");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkRemoveDiploid()
+{
+    {
+        ReturnMessage m(testRemoveDiploid(makeCompleteIntInstance(1, 4), 4, 4, 3*1, 0.0));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testRemoveDiploid(makeCompleteFracInstance(2, 6), 4, 4, 3*2, 0.0));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testRemoveDiploid(makeCompleteFracInstance(2, 6), 4, 4, 3*2, 0.1));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testRemoveDiploid(const InputInstance& instance, const int num_leaves,
+                                      const int max_cn, const int max_e, const double tol)
+{
+    std::cout << "- Check removal of diploid segments with " << instance.numChr() << " chromosomes, "
+              << instance.m() << " samples, " << num_leaves << " leaves, max cn of " << max_cn
+              << ", max events of " << max_e << ", and tolerance " << tol << " : ";
+
+    // a near-diploid segment, off by half the tolerance, is inserted in front of
+    // and after every segment of instance
+    std::stringstream input;
+    input << "#PARAMS" << std::endl;
+    input << instance.numChr() << " #number of chromosomes" << std::endl;
+    input << instance.m() << " #number of samples" << std::endl;
+    for(unsigned int c = 0; c < instance.numChr(); ++c)
+    {
+        input << 2 * instance.n()[c] + 1 << " ";
+    }
+    input << "#number of segments for each chromosome" << std::endl;
+    input << "#SAMPLES" << std::endl;
+    for(unsigned int p = 0; p < instance.m(); ++p)
+    {
+        input << "S" << p+1 << ":";
+        for(unsigned int c = 0; c < instance.numChr(); ++c)
+        {
+            if (c != 0)
+            {
+                input << " |";
+            }
+            input << " " << 2.0 + tol / 2;
+            for(unsigned int s = 0; s < instance.n()[c]; ++s)
+            {
+                input << " " << instance.F()[c][p][s] << " " << 2.0 + tol / 2;
+            }
+        }
+        input << std::endl;
+    }
+
+    InputInstance padded;
+    input >> padded;
+    const InputInstance reduced = padded.removeDiploid(tol);
+
+    if(reduced.numSegments() > instance.numSegments())
+        return ReturnMessage(ReturnType::FAILURE, "The inserted diploid segments have not been removed");
+    if(reduced.numInputSegments() != padded.numSegments())
+        return ReturnMessage(ReturnType::FAILURE, "The reduced instance does not keep the number of input segments");
+
+    // an inserted segment separates every pair of remaining segments, so each
+    // of them becomes a chromosome of its own, unless nothing was removed
+    if(reduced.numSegments() < padded.numSegments())
+    {
+        for(unsigned int c = 0; c < reduced.numChr(); ++c)
+        {
+            if(reduced.n()[c] != 1)
+                return ReturnMessage(ReturnType::FAILURE, "A chromosome of the reduced instance spans a removed segment");
+
+            bool diploid = true;
+            for(unsigned int p = 0; p < reduced.m(); ++p)
+            {
+                diploid = diploid && fabs(reduced.F()[c][p][0] - 2.0) <= tol;
+            }
+            if(diploid)
+                return ReturnMessage(ReturnType::FAILURE, "A diploid segment has not been removed");
+        }
+    }
+
+    // every inserted segment is off by tol/2 in every sample; segments of
+    // instance within tol of the normal diploid are removed as well
+    double distance = 0.0;
+    for(unsigned int c = 0; c < instance.numChr(); ++c)
+    {
+        distance += (instance.n()[c] + 1) * instance.m() * tol / 2;
+        for(unsigned int s = 0; s < instance.n()[c]; ++s)
+        {
+            bool diploid = true;
+            double segment = 0.0;
+            for(unsigned int p = 0; p < instance.m(); ++p)
+            {
+                diploid = diploid && fabs(instance.F()[c][p][s] - 2.0) <= tol;
+                segment += fabs(instance.F()[c][p][s] - 2.0);
+            }
+            if(diploid)
+                distance += segment;
+        }
+    }
+    if(g_tol.different(reduced.diploidDistance(), distance))
+        return ReturnMessage(ReturnType::FAILURE, "The distance of the removed segments is not their distance to the normal diploid");
+
+    const DoubleMatrix M = makeCyclicM(instance.m(), num_leaves);
+    const IntMatrix MAX_CN_padded = makeMaxCN(padded, max_cn);
+    const IntMatrix MAX_CN_reduced = makeMaxCN(reduced, max_cn);
+
+    CArchitect full(padded, M, MAX_CN_padded, max_e, num_leaves, false, false);
+    full.init();
+    full.solve(0,0,0);
+
+    CArchitect removed(reduced, M, MAX_CN_reduced, max_e, num_leaves, false, false);
+    removed.init();
+    removed.solve(0,0,0);
+
+    // every solution of the reduced instance is a solution of the padded one
+    if(g_tol.less(removed.getObjValue() + reduced.diploidDistance(), full.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The reduced instance has a smaller distance than the input");
+
+    const CopyNumberTree inserted = removed.getTree().insertDiploid(padded.n(), reduced.origin());
+    if(inserted.n() != padded.n())
+        return ReturnMessage(ReturnType::FAILURE, "The tree with inserted segments does not have the segmentation of the input");
+
+    if(inserted.cost() != removed.getTree().cost() || inserted.cost() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The tree with inserted segments has a different number of events");
+
+    // the removed segments are fitted by the normal diploid, so measuring the
+    // tree with inserted segments on the input adds exactly their distance
+    if(g_tol.different(FMCSolution(inserted, M, padded).getObjValue(),
+                       removed.getObjValue() + reduced.diploidDistance()))
+        return ReturnMessage(ReturnType::FAILURE, "The distance of the tree with inserted segments differs from the reduced objective");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkFixedTopology()
+{
+    {
+        ReturnMessage m(testFixedTopology(makeCompleteIntInstance(2, 4), 4, 4, 3*2));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testFixedTopology(makeCompleteFracInstance(3, 6), 4, 4, 2*3));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testFixedTopology(const InputInstance& instance, const int num_leaves,
+                                      const int max_cn, const int max_e)
+{
+    std::cout << "- Check fixed-topology decomposition with " << instance.numChr() << " chromosomes, "
+              << instance.m() << " samples, " << num_leaves << " leaves, max cn of " << max_cn
+              << ", and max events of " << max_e << " : ";
+
+    const DoubleMatrix M = makeCyclicM(instance.m(), num_leaves);
+    const IntMatrix MAX_CN = makeMaxCN(instance, max_cn);
+
+    CArchitect full(instance, M, MAX_CN, max_e, num_leaves, false, false);
+    full.init();
+    full.solve(0,0,0);
+
+    // the optimal tree is feasible for its own topology, and no solution
+    // with this topology is better than the optimum
+    TopologyCArchitect decomposed(instance, M, MAX_CN, max_e, num_leaves, false, false,
+                                  TopologyCArchitect::getTopology(full.getTree()));
+    if(!decomposed.solve(0, 0, 2))
+        return ReturnMessage(ReturnType::FAILURE, "The fixed-topology decomposition failed");
+
+    if(g_tol.different(full.getObjValue(), decomposed.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The objective of the decomposition differs from the one of the full model");
+
+    const IntArray& budgets = decomposed.getBudgets();
+    if(std::accumulate(budgets.begin(), budgets.end(), 0) > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The budgets of the chromosomes exceed the maximum number of events");
+
+    if(decomposed.getDelta() > max_e || decomposed.getTree().cost() != decomposed.getDelta())
+        return ReturnMessage(ReturnType::FAILURE, "The tree of the decomposition is inconsistent");
+
+    if(TopologyCArchitect::getTopology(decomposed.getTree()) != TopologyCArchitect::getTopology(full.getTree()))
+        return ReturnMessage(ReturnType::FAILURE, "The tree of the decomposition has a different topology");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkEnumeration()
+{
+    {
+        ReturnMessage m(testEnumeration(makeCompleteIntInstance(2, 4), 3, 4, 2*2));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testEnumeration(makeCompleteFracInstance(1, 6), 4, 4, 3*1));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testEnumeration(const InputInstance& instance, const int num_leaves,
+                                    const int max_cn, const int max_e)
+{
+    std::cout << "- Check enumeration of the topologies with " << instance.numChr() << " chromosomes, "
+              << instance.m() << " samples, " << num_leaves << " leaves, max cn of " << max_cn
+              << ", and max events of " << max_e << " : ";
+
+    const IntMatrix& topologies = TopologyCArchitect::enumerateTopologies(num_leaves);
+    unsigned int count = 1;
+    for(int i = 3; i <= 2*num_leaves - 3; i += 2)
+    {
+        count *= i;
+    }
+    if(topologies.size() != count)
+        return ReturnMessage(ReturnType::FAILURE, "The number of topologies is not (2k-3)!!");
+
+    // with the right count, distinct binary trees are all the topologies
+    std::set<IntArray> distinct;
+    for(const IntArray& parent : topologies)
+    {
+        IntArray nrChildren(2*num_leaves - 1, 0);
+        for(unsigned int j = 1; j < parent.size(); ++j)
+        {
+            ++nrChildren[parent[j]];
+        }
+        for(int i = 0; i < num_leaves - 1; ++i)
+        {
+            if(nrChildren[i] != 2)
+                return ReturnMessage(ReturnType::FAILURE, "A topology is not a binary tree");
+        }
+        distinct.insert(parent);
+    }
+    if(distinct.size() != topologies.size())
+        return ReturnMessage(ReturnType::FAILURE, "A topology is enumerated twice");
+
+    const DoubleMatrix M = makeCyclicM(instance.m(), num_leaves);
+    const IntMatrix MAX_CN = makeMaxCN(instance, max_cn);
+
+    CArchitect full(instance, M, MAX_CN, max_e, num_leaves, false, false);
+    full.init();
+    full.solve(0,0,0);
+
+    double best = -1;
+    for(const IntArray& parent : topologies)
+    {
+        TopologyCArchitect decomposed(instance, M, MAX_CN, max_e, num_leaves, false, false, parent);
+        if(!decomposed.solve(0, 0, 1))
+            return ReturnMessage(ReturnType::FAILURE, "The fixed-topology decomposition failed");
+
+        if(g_tol.less(decomposed.getObjValue(), full.getObjValue()))
+            return ReturnMessage(ReturnType::FAILURE, "A topology is better than the optimum of the full model");
+
+        if(best < 0 || decomposed.getObjValue() < best)
+            best = decomposed.getObjValue();
+    }
+
+    if(g_tol.different(best, full.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The best topology differs from the optimum of the full model");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkLazyConstraints()
+{
+    {
+        ReturnMessage m(testLazyConstraints(makeCompleteIntInstance(2, 4), 4, 4, 3*2));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testLazyConstraints(makeCompleteFracInstance(2, 6), 4, 4, 3*2));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testLazyConstraints(const InputInstance& instance, const int num_leaves,
+                                        const int max_cn, const int max_e)
+{
+    std::cout << "- Check lazy constraints with " << instance.numChr() << " chromosomes, "
+              << instance.m() << " samples, " << num_leaves << " leaves, max cn of " << max_cn
+              << ", and max events of " << max_e << " : ";
+
+    const DoubleMatrix M = makeCyclicM(instance.m(), num_leaves);
+    const IntMatrix MAX_CN = makeMaxCN(instance, max_cn);
+
+    CArchitect eager(instance, M, MAX_CN, max_e, num_leaves, false, false);
+    eager.init();
+    eager.solve(0,0,0);
+
+    CArchitect lazy(instance, M, MAX_CN, max_e, num_leaves, false, false);
+    lazy.setLazyConstraints(true);
+    lazy.init();
+    lazy.solve(0,0,0);
+
+    if(g_tol.different(eager.getObjValue(), lazy.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The objective with lazy constraints differs from the one without");
+
+    if(lazy.getDelta() > max_e || lazy.getTree().cost() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The tree with lazy constraints exceeds the maximum number of events");
+
+    // every row left out of the lazy model is handed to CPLEX as a lazy row
+    if(eager.getNumLazyRows() != 0 || lazy.getNumLazyRows() == 0)
+        return ReturnMessage(ReturnType::FAILURE, "The arc rows have not been set aside as lazy rows");
+
+    if(eager.getNumRows() - lazy.getNumRows() != lazy.getNumLazyRows())
+    {
+        std::stringstream message;
+        message << "The lazy model has " << eager.getNumRows() - lazy.getNumRows()
+                << " rows less than the eager one but " << lazy.getNumLazyRows() << " lazy rows";
+        return ReturnMessage(ReturnType::FAILURE, message.str());
+    }
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkBoundTightening()
+{
+    {
+        ReturnMessage m(testBoundTightening(1));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testBoundTightening(2));
+        switch(m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testBoundTightening(const int num_chr)
+{
+    std::cout << "- Check tightened bounds with per-segment max cn, the normal diploid clone forced and "
+              << num_chr << " chromosomes : ";
+
+    /**
+     Every chromosome is explained exactly by the tree root -> {diploid leaf, v},
+     v -> {leaf 1, leaf 2} with three events: a deletion of 1 on [0,2] into v, an
+     amplification of 3 on [0,0] into leaf 1 and a deletion of 1 on [1,1] into
+     leaf 2. The amplification attains the cap max_s e_s - 1 and leaf 1 attains
+     e_0, so the optimum is zero only if the caps cut off no solution.
+     **/
+    const int num_leaves = 3;
+    const int max_e = 3 * num_chr;
+    const DoubleMatrix profiles = {{2.0, 2.0, 2.0}, {4.0, 1.0, 1.0}, {1.0, 0, 1.0}};
+
+    std::stringstream input;
+    input << "#PARAMS" << std::endl;
+    input << num_chr << " #number of chromosomes" << std::endl;
+    input << num_leaves << " #number of samples" << std::endl;
+    for(unsigned int c = 0; c < num_chr; ++c)
+    {
+        input << 3 << " ";
+    }
+    input << "#number of segments for each chromosome" << std::endl;
+    input << "#SAMPLES" << std::endl;
+    for(unsigned int p = 0; p < num_leaves; ++p)
+    {
+        input << "S" << p+1 << ":";
+        for(unsigned int c = 0; c < num_chr; ++c)
+        {
+            if (c != 0)
+            {
+                input << " |";
+            }
+            for(unsigned int s = 0; s < 3; ++s)
+            {
+                input << " " << profiles[p][s];
+            }
+        }
+        input << std::endl;
+    }
+
+    InputInstance instance;
+    input >> instance;
+
+    const DoubleMatrix M = makeCyclicM(num_leaves, num_leaves);
+
+    const IntMatrix e(num_chr, IntArray({4, 2, 3}));
+
+    CArchitect tightened(instance, M, e, max_e, num_leaves, false, true);
+    tightened.init();
+    tightened.solve(0,0,0);
+
+    if(g_tol.nonZero(tightened.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The tightened bounds cut off the exact solution");
+
+    if(tightened.getTree().cost() > max_e)
+        return ReturnMessage(ReturnType::FAILURE, "The tree exceeds the maximum number of events");
+
+    const IntRaggedArray C = tightened.getC();
+    for(unsigned int c = 0; c < num_chr; ++c)
+    {
+        for(unsigned int i = 0; i < num_leaves; ++i)
+        {
+            for(unsigned int s = 0; s < 3; ++s)
+            {
+                if(C[c][i][s] > e[c][s] || (i == 0 && C[c][i][s] != 2))
+                    return ReturnMessage(ReturnType::FAILURE, "A leaf profile violates its bounds");
+            }
+        }
+    }
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
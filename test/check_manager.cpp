@@ -15,12 +15,33 @@ const ReturnMessage testUntil(const InputInstance &inst, const unsigned int num_
 
 int checkFMCSolution(const FMCSolution &sol);
 
+int checkResultCache();
+const ReturnMessage testResultCache(const InputInstance &inst, const unsigned int num_leaves,
+                                    const unsigned int max_cn, const unsigned int max_events);
+
+int checkCheckpoint();
+const ReturnMessage testCheckpoint(const InputInstance &inst, const unsigned int num_leaves,
+                                   const unsigned int max_cn, const unsigned int max_events);
+
+int checkAdaptiveSeeds();
+const ReturnMessage testAdaptiveSeeds(const InputInstance &inst, const unsigned int num_leaves,
+                                      const unsigned int max_cn, const unsigned int max_events,
+                                      const int patience, const int confirmations, const int expected);
+
+int checkSpeculative();
+const ReturnMessage testSpeculative(const InputInstance &inst, const unsigned int num_leaves,
+                                    const unsigned int max_cn, const unsigned int max_events);
+
+int checkHarvest();
+const ReturnMessage testHarvest(const InputInstance &inst, const unsigned int num_leaves,
+                                const unsigned int max_cn, const unsigned int max_events);
+
 
 
 int main(int argc, char** argv)
 {
     g_verbosity = VERBOSE_DEBUG;
-    g_rng = boost::mt19937(1);
+    g_rng = std::mt19937(1);
 
     std::cout << "CHECKING MANAGER" << std::endl;
 
@@ -28,6 +49,16 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     if(checkComplete() == EXIT_FAILURE)
         return EXIT_FAILURE;
+    if(checkResultCache() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkCheckpoint() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkAdaptiveSeeds() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkSpeculative() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkHarvest() == EXIT_FAILURE)
+        return EXIT_FAILURE;
 
     return EXIT_SUCCESS;
 }
@@ -396,3 +427,346 @@ int checkFMCSolution(const FMCSolution &sol)
 }
 
 
+int checkResultCache()
+{
+    {
+        ReturnMessage m(testResultCache(makeUnevenIntInstance(3, 4), 4, 4, 2*3));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testResultCache(const InputInstance &inst, const unsigned int num_leaves,
+                                    const unsigned int max_cn, const unsigned int max_events)
+{
+    std::cout << "- Check cache entry round trip with " << inst.numChr() << " chromosomes, " << inst.m()
+              << " samples, " << num_leaves << " leaves, " << max_cn << " max cn, " << max_events << " max events : ";
+
+    const IntMatrix e = makeMaxCN(inst, max_cn);
+
+    Manager manager(inst, num_leaves, e, max_events, max_events, false, false, true, 10, 1, 2, 2, 1, 0, 0, 0, 0.0);
+    manager.runIterative();
+    const FMCSolution sol = manager.getSolution();
+
+    // the hot starts of seeds that were not run are empty, as is the last one of an inherited solution
+    ResultCache::Entry entry;
+    entry._objValue = manager.getObjValue() + 1.0 / 3.0;
+    entry._bestSeed = 1;
+    entry._T = sol.getTree();
+    entry._C = sol.getTree().getLeafProfiles();
+    entry._M = sol.getM();
+    entry._firstCompleteHotStart = {HotStart(), HotStart({1, 0, 3, 2}), HotStart()};
+    entry._lastCompleteHotStart = HotStart();
+
+    std::stringstream out;
+    ResultCache::write(out, entry);
+
+    ResultCache::Entry copy;
+    std::stringstream in(out.str());
+    try {
+        ResultCache::read(in, copy);
+    } catch (const std::runtime_error& ex) {
+        return ReturnMessage(ReturnType::FAILURE, std::string("The entry cannot be read back: ") + ex.what());
+    }
+
+    if(copy._objValue != entry._objValue || copy._bestSeed != entry._bestSeed)
+        return ReturnMessage(ReturnType::FAILURE, "The distance or the seed differ after the round trip");
+    if(copy._C != entry._C || copy._C.n() != inst.n())
+        return ReturnMessage(ReturnType::FAILURE, "The leaf profiles differ after the round trip");
+    if(copy._M != entry._M)
+        return ReturnMessage(ReturnType::FAILURE, "The usage matrix differs after the round trip");
+    if(copy._firstCompleteHotStart != entry._firstCompleteHotStart || copy._lastCompleteHotStart != entry._lastCompleteHotStart)
+        return ReturnMessage(ReturnType::FAILURE, "The hot starts differ after the round trip");
+
+    std::stringstream tree, treeCopy;
+    tree << entry._T;
+    treeCopy << copy._T;
+    if(tree.str() != treeCopy.str())
+        return ReturnMessage(ReturnType::FAILURE, "The tree differs after the round trip");
+
+    // an entry truncated after the leaf profiles must be rejected instead of being partially restored
+    const std::string truncated = out.str().substr(0, out.str().find("#M"));
+    std::stringstream inTruncated(truncated);
+    try {
+        ResultCache::read(inTruncated, copy);
+    } catch (const std::runtime_error& ex) {
+        return ReturnMessage(ReturnType::SUCCESS);
+    }
+
+    return ReturnMessage(ReturnType::FAILURE, "A truncated entry has been read");
+}
+
+
+int checkCheckpoint()
+{
+    {
+        ReturnMessage m(testCheckpoint(makeUnevenIntInstance(2, 4), 4, 4, 3*2));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testCheckpoint(const InputInstance &inst, const unsigned int num_leaves,
+                                   const unsigned int max_cn, const unsigned int max_events)
+{
+    std::cout << "- Check checkpoint round trip with " << inst.numChr() << " chromosomes, " << inst.m()
+              << " samples, " << num_leaves << " leaves, " << max_cn << " max cn, " << max_events << " max events : ";
+
+    const std::string filename = "check_manager.checkpoint";
+    std::remove(filename.c_str());
+
+    const IntMatrix e = makeMaxCN(inst, max_cn);
+
+    // the base seed is drawn from g_rng, a resumed run must draw the same one
+    g_rng = std::mt19937(1);
+    Manager interrupted(inst, num_leaves, e, max_events-1, max_events, false, false, true, 10, 1, 2, 2, 1, 0, 0, 0, 0.0);
+    interrupted.setCheckpoint(filename, false);
+    interrupted.runIterative();
+
+    g_rng = std::mt19937(1);
+    Manager resumed(inst, num_leaves, e, max_events-1, max_events, false, false, true, 10, 1, 2, 2, 1, 0, 0, 0, 0.0);
+    resumed.setCheckpoint(filename, true);
+    try {
+        resumed.runIterative();
+    } catch (const std::runtime_error& ex) {
+        std::remove(filename.c_str());
+        return ReturnMessage(ReturnType::FAILURE, std::string("The checkpoint cannot be resumed: ") + ex.what());
+    }
+
+    std::stringstream tree, treeResumed;
+    tree << interrupted.getSolution().getTree();
+    treeResumed << resumed.getSolution().getTree();
+    if(g_tol.different(interrupted.getObjValue(), resumed.getObjValue()) || tree.str() != treeResumed.str())
+    {
+        std::remove(filename.c_str());
+        return ReturnMessage(ReturnType::FAILURE, "The resumed run differs from the run that wrote the checkpoint");
+    }
+
+    // a different number of seeds is rejected by the header
+    g_rng = std::mt19937(1);
+    Manager moreSeeds(inst, num_leaves, e, max_events-1, max_events, false, false, true, 10, 1, 2, 3, 1, 0, 0, 0, 0.0);
+    moreSeeds.setCheckpoint(filename, true);
+    bool rejected = false;
+    try {
+        moreSeeds.runIterative();
+    } catch (const std::runtime_error& ex) {
+        rejected = std::string(ex.what()).find("different seeds") != std::string::npos;
+    }
+    if(!rejected)
+    {
+        std::remove(filename.c_str());
+        return ReturnMessage(ReturnType::FAILURE, "A checkpoint with a different number of seeds has been resumed");
+    }
+
+    // a different maximum copy number is only caught by the hash of the parameters
+    const IntMatrix larger_e = makeMaxCN(inst, max_cn+1);
+    g_rng = std::mt19937(1);
+    Manager otherE(inst, num_leaves, larger_e, max_events-1, max_events, false, false, true, 10, 1, 2, 2, 1, 0, 0, 0, 0.0);
+    otherE.setCheckpoint(filename, true);
+    rejected = false;
+    try {
+        otherE.runIterative();
+    } catch (const std::runtime_error& ex) {
+        rejected = std::string(ex.what()).find("different instance") != std::string::npos;
+    }
+    std::remove(filename.c_str());
+    if(!rejected)
+        return ReturnMessage(ReturnType::FAILURE, "A checkpoint written with a different maximum copy number has been resumed");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkAdaptiveSeeds()
+{
+    // every seed reaches the all-diploid tree at distance 0, so the first
+    // seed improves on the initial distance and every later seed confirms it
+    {
+        ReturnMessage m(testAdaptiveSeeds(makeAllEqualInstance(2,4,5,2.0),3,4,2*2,-1,-1,5));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testAdaptiveSeeds(makeAllEqualInstance(2,4,5,2.0),3,4,2*2,2,-1,3));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testAdaptiveSeeds(makeAllEqualInstance(2,4,5,2.0),3,4,2*2,-1,2,2));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testAdaptiveSeeds(const InputInstance &inst, const unsigned int num_leaves,
+                                      const unsigned int max_cn, const unsigned int max_events,
+                                      const int patience, const int confirmations, const int expected)
+{
+    std::cout << "- Check adaptive seeds with " << inst.numChr() << " chromosomes, " << inst.m()
+              << " samples, " << num_leaves << " leaves, " << max_cn << " max cn, " << max_events
+              << " max events, patience " << patience << ", and confirmations " << confirmations << " : ";
+
+    const IntMatrix e = makeMaxCN(inst, max_cn);
+
+    // more seeds than workers, such that the seeds are launched one at a time
+    const int nrSeeds = 5;
+    Manager manager(inst, num_leaves, e, max_events, max_events, false, false, true, 10, 1, 2, nrSeeds, 1, 0, 0, 0, 0.0);
+    manager.setAdaptiveSeeds(patience, confirmations);
+    manager.runReverse();
+
+    if(g_tol.nonZero(manager.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The all-diploid tree has not been found");
+
+    if(manager.getNrLaunchedSeeds(max_events) != expected)
+    {
+        std::stringstream message;
+        message << manager.getNrLaunchedSeeds(max_events) << " seeds have been launched instead of " << expected;
+        return ReturnMessage(ReturnType::FAILURE, message.str());
+    }
+
+    // the budget only holds back the seeds that wait for a free worker
+    Manager parallel(inst, num_leaves, e, max_events, max_events, false, false, true, 10, 1, 2, nrSeeds, nrSeeds, 0, 0, 0, 0.0);
+    parallel.setAdaptiveSeeds(patience, confirmations);
+    parallel.runReverse();
+
+    if(parallel.getNrLaunchedSeeds(max_events) != nrSeeds)
+        return ReturnMessage(ReturnType::FAILURE, "Seeds have been held back although every seed had a free worker");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkSpeculative()
+{
+    {
+        ReturnMessage m(testSpeculative(makeAllEqualInstance(2,4,5,2.0),3,4,2*2));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testSpeculative(const InputInstance &inst, const unsigned int num_leaves,
+                                    const unsigned int max_cn, const unsigned int max_events)
+{
+    std::cout << "- Check speculative binary search with " << inst.numChr() << " chromosomes, " << inst.m()
+              << " samples, " << num_leaves << " leaves, " << max_cn << " max cn, and " << max_events << " max events : ";
+
+    const IntMatrix e = makeMaxCN(inst, max_cn);
+
+    // one seed and four workers, such that three midpoints run next to UZ
+    Manager sequential(inst, num_leaves, e, 0, max_events, false, false, true, 10, 1, 2, 1, 4, 0, 0, 0, 0.0);
+    sequential.runBinarySearch();
+
+    Manager speculative(inst, num_leaves, e, 0, max_events, false, false, true, 10, 1, 2, 1, 4, 0, 0, 0, 0.0);
+    speculative.setSpeculative(true);
+    speculative.runBinarySearch();
+
+    if(g_tol.different(sequential.getObjValue(), speculative.getObjValue()))
+        return ReturnMessage(ReturnType::FAILURE, "The speculative search found a different distance");
+
+    if(sequential.getSlopePoint() != speculative.getSlopePoint())
+        return ReturnMessage(ReturnType::FAILURE, "The speculative search selected a different number of events");
+
+    // every distance is 0, so the sequential search visits 4, 2, 1 and 0 only,
+    // while the first speculation launches the midpoints 2, 3 and 1 at once
+    if(sequential.getNrLaunchedSeeds(max_events - 1) != 0)
+        return ReturnMessage(ReturnType::FAILURE, "The sequential search evaluated a midpoint it did not need");
+
+    if(speculative.getNrLaunchedSeeds(max_events - 1) == 0)
+        return ReturnMessage(ReturnType::FAILURE, "The speculative search did not launch the next midpoints");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkHarvest()
+{
+    {
+        ReturnMessage m(testHarvest(makeCompleteIntInstance(1,4),4,4,3*1));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testHarvest(const InputInstance &inst, const unsigned int num_leaves,
+                                const unsigned int max_cn, const unsigned int max_events)
+{
+    std::cout << "- Check harvested seeds with " << inst.numChr() << " chromosomes, " << inst.m()
+              << " samples, " << num_leaves << " leaves, " << max_cn << " max cn, and " << max_events << " max events : ";
+
+    const IntMatrix e = makeMaxCN(inst, max_cn);
+
+    // a pool larger than the number of seeds could replace every seed
+    const int nrSeeds = 3;
+    Manager manager(inst, num_leaves, e, 0, max_events, false, false, true, 10, 1, 2, nrSeeds, 1, 0, 0, 0, 0.0);
+    manager.setPoolSize(nrSeeds + 1);
+    manager.runBinarySearch();
+
+    // the binary search starts at UZ, below which nothing has been computed yet
+    if(manager.getNrHarvestedSeeds(max_events) != 0)
+        return ReturnMessage(ReturnType::FAILURE, "A candidate has been taken before any smaller Z was computed");
+
+    for(unsigned int Z = 0; Z <= max_events; ++Z)
+    {
+        if(manager.getNrHarvestedSeeds(Z) > nrSeeds - 1)
+        {
+            std::stringstream message;
+            message << "The first seed of Z=" << Z << " does not start from a random usage matrix";
+            return ReturnMessage(ReturnType::FAILURE, message.str());
+        }
+    }
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
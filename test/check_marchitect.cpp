@@ -1,5 +1,6 @@
 #include "basic_check.h"
 #include "marchitect.h"
+#include "msolver.h"
 
 
 const InputInstance makeInstance(Double3Array &F);
@@ -17,6 +18,13 @@ int checkFewLeaves();
 const ReturnMessage testBetween(const InputInstance &inst, const unsigned int max_cn,
                                const unsigned int lb, const unsigned int ub);
 
+int checkUpdateC();
+const ReturnMessage testUpdateC(const InputInstance &inst, const unsigned int max_cn);
+
+int checkMSolver();
+const ReturnMessage testMSolver(const InputInstance &inst, const unsigned int num_leaves,
+                                const unsigned int max_cn, const int nrThreads);
+
 
 int main(int argc, char** argv)
 {
@@ -29,6 +37,10 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     if(checkFewLeaves() == EXIT_FAILURE)
         return EXIT_FAILURE;
+    if(checkUpdateC() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkMSolver() == EXIT_FAILURE)
+        return EXIT_FAILURE;
 
     return EXIT_SUCCESS;
 }
@@ -962,3 +974,192 @@ const ReturnMessage testBetween(const InputInstance &inst, const unsigned int ma
 
     return ReturnMessage(ReturnType::SUCCESS, "The objective value is zero");
 }
+
+
+int checkUpdateC()
+{
+    {
+        ReturnMessage m(testUpdateC(makeFInt(1, 4), 4));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testUpdateC(makeFInt(4, 6), 4));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testUpdateC(const InputInstance &inst, const unsigned int max_cn)
+{
+    std::cout << "- Check update of C in place with " << inst.numChr()
+              << " chromosomes, " << inst.F()[0].size() << " samples : ";
+
+    Int3Array C(inst.F().size(),
+                IntMatrix(inst.F()[0].size(),
+                          IntArray(inst.F()[0][0].size(), 0)));
+    Int3Array C0(inst.F().size(),
+                 IntMatrix(inst.F()[0].size(),
+                           IntArray(inst.F()[0][0].size(), 2)));
+
+    for(unsigned int c = 0; c < C.size(); ++c)
+    {
+        for(unsigned int p = 0; p < C[0].size(); ++p)
+        {
+            for(unsigned int s = 0; s < C[0][0].size(); ++s)
+            {
+                C[c][p][s] = inst.F()[c][p][s];
+            }
+        }
+    }
+
+    IntMatrix e(C.size(), IntArray(C[0][0].size(), max_cn));
+
+    MArchitect architect(inst, C0, C[0].size(), e);
+    architect.init();
+    architect.solve(0, 0);
+    architect.updateC(C);
+    architect.solve(0, 0);
+
+    DoubleMatrix M(architect.getM());
+
+    for(unsigned int i = 0; i < M.size(); ++i)
+    {
+        double sum = 0.0;
+        for(unsigned int j = 0; j < M[i].size(); ++j)
+        {
+            sum += M[i][j];
+        }
+        if(sum < 0.999 || sum > 1.001)
+            return ReturnMessage(ReturnType::FAILURE, "The sum of the rows is not 1");
+    }
+
+    if(architect.getObjValue() > 0.00001)
+        return ReturnMessage(ReturnType::FAILURE, "The objective function after updating C is non-zero");
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkMSolver()
+{
+    {
+        ReturnMessage m(testMSolver(makeFDouble(1, 4), 3, 4, 1));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testMSolver(makeFDouble(4, 6), 4, 4, 2));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testMSolver(makeFInt(2, 8), 6, 5, 4));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testMSolver(const InputInstance &inst, const unsigned int num_leaves,
+                                const unsigned int max_cn, const int nrThreads)
+{
+    std::cout << "- Check native M-step against the LP with " << inst.numChr()
+              << " chromosomes, " << inst.F()[0].size() << " samples, " << num_leaves
+              << " leaves : ";
+
+    unsigned int numChr = inst.F().size();
+    unsigned int numSeg = inst.F()[0][0].size();
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> cn(0, max_cn);
+    Int3Array C(numChr,
+                IntMatrix(num_leaves,
+                          IntArray(numSeg, 0)));
+    for(unsigned int c = 0; c < numChr; ++c)
+    {
+        for(unsigned int i = 0; i < num_leaves; ++i)
+        {
+            for(unsigned int s = 0; s < numSeg; ++s)
+            {
+                C[c][i][s] = cn(rng);
+            }
+        }
+    }
+
+    IntMatrix e(numChr, IntArray(numSeg, max_cn));
+
+    // the second round starts from the bases of the first one
+    MSolver solver(inst, C, num_leaves);
+    for(unsigned int round = 0; round < 2; ++round)
+    {
+        MArchitect architect(inst, C, num_leaves, e);
+        architect.init();
+        architect.solve(0, 0);
+
+        solver.updateC(C);
+        if(!solver.solve(nrThreads))
+            return ReturnMessage(ReturnType::FAILURE, "The native M-step did not converge");
+
+        if(g_tol.different(solver.getObjValue(), architect.getObjValue()))
+            return ReturnMessage(ReturnType::FAILURE, "The native M-step differs from the LP");
+
+        DoubleMatrix M(solver.getM());
+        for(unsigned int p = 0; p < M.size(); ++p)
+        {
+            double sum = 0.0;
+            for(unsigned int i = 0; i < M[p].size(); ++i)
+            {
+                if(M[p][i] < 0)
+                    return ReturnMessage(ReturnType::FAILURE, "Negative proportion");
+                sum += M[p][i];
+            }
+            if(sum < 0.999 || sum > 1.001)
+                return ReturnMessage(ReturnType::FAILURE, "The sum of the rows is not 1");
+        }
+
+        // change some copy numbers for the second round
+        for(unsigned int c = 0; c < numChr; ++c)
+        {
+            for(unsigned int s = 0; s < numSeg; s += 3)
+            {
+                C[c][0][s] = cn(rng);
+            }
+        }
+    }
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
@@ -11,6 +11,15 @@ int checkComplete();
 const ReturnMessage testComplete(const InputInstance &inst, const unsigned int num_leaves,
                                  const unsigned int max_cn, const unsigned int max_events);
 
+int checkIncumbent();
+const ReturnMessage testIncumbent(const InputInstance &inst, const unsigned int num_leaves,
+                                  const unsigned int max_cn, const unsigned int max_events);
+
+int checkHarvest();
+const ReturnMessage testHarvest(const InputInstance &inst, const unsigned int num_leaves,
+                                const unsigned int max_cn, const unsigned int max_events,
+                                const int pool_size);
+
 
 
 int main(int argc, char** argv)
@@ -22,6 +31,10 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     if(checkComplete() == EXIT_FAILURE)
         return EXIT_FAILURE;
+    if(checkIncumbent() == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if(checkHarvest() == EXIT_FAILURE)
+        return EXIT_FAILURE;
 
     return EXIT_SUCCESS;
 }
@@ -518,3 +531,192 @@ const ReturnMessage testComplete(const InputInstance &inst, const unsigned int n
 
     return ReturnMessage(ReturnType::SUCCESS);
 }
+
+
+int checkIncumbent()
+{
+    {
+        ReturnMessage m(testIncumbent(makeCompleteIntInstance(1,3),4,3,3*1));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testIncumbent(makeCompleteIntInstance(1,4),4,3,3*1));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testIncumbent(const InputInstance &inst, const unsigned int num_leaves,
+                                  const unsigned int max_cn, const unsigned int max_events)
+{
+    std::cout << "- Check incumbent sharing with " << inst.numChr() << " chromosomes, " << inst.m()
+              << " samples, " << num_leaves << " leaves, " << max_cn << " max cn, "
+              << max_events << " max events : ";
+
+    const DoubleMatrix M0 = makeCyclicM(inst.m(), num_leaves);
+    const IntMatrix e = makeMaxCN(inst, max_cn);
+
+    // the first seed posts its distance after every M-step
+    IncumbentBoard board;
+    Worker first(inst, num_leaves, e, max_events, false, false, 1, 2, 0, 0, 0, M0, 0);
+    first.setIncumbentBoard(&board);
+    const double objFirst = first.solve();
+
+    if(board.getSeed() != 0 || g_tol.different(board.getObjValue(), objFirst) || !board.getCompleteHotStart())
+        return ReturnMessage(ReturnType::FAILURE, "The board does not hold the distance of the first seed");
+
+    // a worse distance does not replace the incumbent
+    if(board.post(objFirst + 1, 1, HotStart()) || board.getSeed() != 0)
+        return ReturnMessage(ReturnType::FAILURE, "A worse distance replaced the incumbent");
+
+    // the second seed starts from another M, gets the hot start of the first
+    // and stops as soon as it is above the incumbent
+    const DoubleMatrix M1(inst.m(), DoubleArray(num_leaves, 1.0 / num_leaves));
+    Worker second(inst, num_leaves, e, max_events, false, false, 1, 2, 0, 0, 0, M1, 1);
+    second.setIncumbentBoard(&board);
+    second.setTerminationRatio(1.0);
+    second.setInjectHotStarts(true);
+    const double objSecond = second.solve();
+
+    if(g_tol.different(board.getObjValue(), std::min(objFirst, objSecond)))
+        return ReturnMessage(ReturnType::FAILURE, "The board does not hold the best distance");
+
+    if(board.getSeed() != (g_tol.less(objSecond, objFirst) ? 1 : 0))
+        return ReturnMessage(ReturnType::FAILURE, "The board does not name the seed holding the best distance");
+
+    if(second.isCutOff() != g_tol.less(objFirst, objSecond))
+        return ReturnMessage(ReturnType::FAILURE, "The second seed did not stop exactly when it was above the incumbent");
+
+    // no copy number exceeds max_cn, so every distance is at least the total
+    // excess of F over max_cn; an incumbent of 0 cuts off every seed after
+    // its first M-step, well before it could converge
+    double excess = 0.0;
+    for(unsigned int c = 0; c < inst.numChr(); ++c)
+        for(unsigned int p = 0; p < inst.m(); ++p)
+            for(unsigned int s = 0; s < inst.n()[c]; ++s)
+                excess += std::max(inst.F()[c][p][s] - max_cn, 0.0);
+    if(!g_tol.nonZero(excess))
+        return ReturnMessage(ReturnType::FAILURE, "The instance can be fitted exactly");
+
+    IncumbentBoard unreachable;
+    unreachable.post(0.0, 0, *board.getCompleteHotStart());
+    Worker third(inst, num_leaves, e, max_events, false, false, 3, 10, 0, 0, 0, M1, 2);
+    third.setIncumbentBoard(&unreachable);
+    third.setTerminationRatio(1.0);
+    third.solve();
+
+    if(!third.isCutOff() || third.getNrIterations() != 1)
+        return ReturnMessage(ReturnType::FAILURE, "The seed did not stop after its first M-step");
+    if(unreachable.getSeed() != 0)
+        return ReturnMessage(ReturnType::FAILURE, "A worse distance replaced the incumbent");
+
+    DoubleMatrix M(third.getM());
+    for(unsigned int i = 0; i < M.size(); ++i)
+    {
+        double sum = 0.0;
+        for(unsigned int j = 0; j < M[i].size(); ++j)
+        {
+            sum += M[i][j];
+        }
+        if(g_tol.different(sum, 1.0))
+            return ReturnMessage(ReturnType::FAILURE, "The sum of the rows is not 1");
+    }
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}
+
+
+int checkHarvest()
+{
+    {
+        ReturnMessage m(testHarvest(makeCompleteIntInstance(1,4),4,4,3*1,3));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    {
+        ReturnMessage m(testHarvest(makeCompleteFracInstance(2,6),4,4,3*2,5));
+        switch (m.type)
+        {
+            case(ReturnType::SUCCESS): std::cout << "SUCCESS" << std::endl; break;
+            default:
+                std::cout << "FAILED" << std::endl << m.message << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+const ReturnMessage testHarvest(const InputInstance &inst, const unsigned int num_leaves,
+                                const unsigned int max_cn, const unsigned int max_events,
+                                const int pool_size)
+{
+    std::cout << "- Check harvesting of the solution pool with " << inst.numChr() << " chromosomes, " << inst.m()
+              << " samples, " << num_leaves << " leaves, " << max_cn << " max cn, " << max_events
+              << " max events, and a pool of " << pool_size << " : ";
+
+    const DoubleMatrix M0 = makeCyclicM(inst.m(), num_leaves);
+    const IntMatrix e = makeMaxCN(inst, max_cn);
+
+    Worker worker(inst, num_leaves, e, max_events, false, false, 1, 2, 0, 0, 0, M0, 0);
+    worker.setPoolSize(pool_size);
+    worker.solve();
+
+    const std::vector<Worker::Candidate>& candidates = worker.getCandidates();
+    if((int)candidates.size() > pool_size)
+        return ReturnMessage(ReturnType::FAILURE, "More candidates have been harvested than the size of the pool");
+
+    for(unsigned int i = 0; i < candidates.size(); ++i)
+    {
+        if(i > 0 && candidates[i] < candidates[i-1])
+            return ReturnMessage(ReturnType::FAILURE, "The candidates are not sorted by increasing distance");
+
+        // the incumbent of the first C-step is the starting point of the seed itself
+        if(candidates[i]._completeHotStart == worker.getFirstCompleteHotStart())
+            return ReturnMessage(ReturnType::FAILURE, "A candidate repeats the first C-step of the seed");
+
+        for(unsigned int j = 0; j < i; ++j)
+        {
+            if(candidates[i]._completeHotStart == candidates[j]._completeHotStart)
+                return ReturnMessage(ReturnType::FAILURE, "A solution has been harvested twice");
+        }
+
+        if(candidates[i]._M.size() != inst.m())
+            return ReturnMessage(ReturnType::FAILURE, "The usage matrix of a candidate does not have a row per sample");
+
+        for(const DoubleArray& M_p : candidates[i]._M)
+        {
+            double sum = 0.0;
+            for(double value : M_p)
+            {
+                sum += value;
+            }
+            if(g_tol.different(sum, 1.0))
+                return ReturnMessage(ReturnType::FAILURE, "The sum of the rows of a candidate is not 1");
+        }
+    }
+
+    return ReturnMessage(ReturnType::SUCCESS);
+}